@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cerrno> // EINVAL e ENOMEM do posix_memalign.
+#include <cstddef> // size_t.
+#include <cstdlib> // malloc e free.
+#include <new> // operator new.
+
+/**
+ * @brief Conta as alocações de memória da thread atual, para conferir que um laço não aloca.
+ *
+ * Só conta quando o programa é compilado com -DALLOC_COUNTER; sem isso enabled() é false
+ * e a contagem fica em zero. Com a glibc as funções malloc/calloc/realloc/memalign são
+ * substituídas, o que pega também os buffers dos Mats do OpenCV (que não passam pelo
+ * new); em outros sistemas só o operator new é substituído.
+ *
+ * Substitui funções globais: inclua em um único .cpp do programa.
+ *
+ *     AllocationCounter counter;
+ *     ... laço ...
+ *     if (counter.count() > 0) ... // Alocou.
+ */
+namespace alloc_counter {
+inline thread_local size_t threadAllocations = 0; // Tipo trivial: não aloca no primeiro acesso.
+}
+
+class AllocationCounter {
+public:
+    AllocationCounter() : start(alloc_counter::threadAllocations) {}
+
+    /** @brief Alocações feitas por esta thread desde a construção (ou o último reset). */
+    size_t count() const {
+        return alloc_counter::threadAllocations - start;
+    }
+
+    void reset() {
+        start = alloc_counter::threadAllocations;
+    }
+
+    static bool enabled() {
+#ifdef ALLOC_COUNTER
+        return true;
+#else
+        return false;
+#endif
+    }
+
+private:
+    size_t start;
+};
+
+#ifdef ALLOC_COUNTER
+#if defined(__GLIBC__)
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+
+void* malloc(size_t size) {
+    alloc_counter::threadAllocations++;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    alloc_counter::threadAllocations++;
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    alloc_counter::threadAllocations++;
+    return __libc_realloc(ptr, size);
+}
+
+void* memalign(size_t alignment, size_t size) {
+    alloc_counter::threadAllocations++;
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    alloc_counter::threadAllocations++;
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** ptr, size_t alignment, size_t size) {
+    if (alignment == 0 || alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0)
+        return EINVAL; // Precisa ser potência de 2 e múltiplo de sizeof(void*); *ptr fica como estava.
+    alloc_counter::threadAllocations++;
+    void* p = __libc_memalign(alignment, size);
+    if (!p && size != 0)
+        return ENOMEM;
+    *ptr = p;
+    return 0;
+}
+}
+#else
+void* operator new(size_t size) {
+    alloc_counter::threadAllocations++;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    std::free(p);
+}
+#endif
+#endif
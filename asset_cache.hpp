@@ -0,0 +1,231 @@
+#pragma once
+
+#include <opencv2/core.hpp> // Mat e tipos básicos do OpenCV.
+#include <opencv2/imgcodecs.hpp> // imread.
+#include <opencv2/imgproc.hpp> // resize.
+#include <opencv2/freetype.hpp> // Fontes TrueType.
+#include <chrono> // Relógio para throttling do hot-reload.
+#include <filesystem> // Data de modificação dos arquivos.
+#include <functional> // std::hash do id da thread.
+#include <iostream> // Relatório de estatísticas.
+#include <map> // Tabela de assets carregados.
+#include <memory> // shared_ptr dos handles.
+#include <mutex> // Protege o cache quando usado por várias threads.
+#include <string> // Chaves e caminhos.
+#include <thread> // Fonte de cada thread.
+#include "sprite.hpp" // Formato pronto para desenhar.
+
+/**
+ * @brief Cache de imagens, sprites e fontes carregados do disco.
+ *
+ * Cada asset é decodificado, redimensionado e convertido uma única vez e entregue
+ * como um handle compartilhado e imutável. A chave é o caminho junto com o tamanho
+ * pedido, então o mesmo arquivo em dois tamanhos vira duas entradas. Com hotReload
+ * ligado, a data de modificação do arquivo é conferida de tempos em tempos e o asset
+ * é recarregado se o arquivo mudar; quem ainda segura o handle antigo continua com ele.
+ *
+ * Fontes são a exceção à imutabilidade: o FreeType2 guarda estado que o putText altera.
+ * Por isso cada thread recebe a sua própria instância (carregada uma vez por thread), e
+ * o handle de uma fonte não deve ser passado para outra thread.
+ *
+ * Falhas de carga também ficam no cache (como handle nulo), para não tentar ler
+ * de novo o mesmo arquivo inexistente a cada frame.
+ */
+class AssetCache {
+public:
+    typedef std::shared_ptr<const cv::Mat> ImageHandle;
+    typedef std::shared_ptr<const Sprite> SpriteHandle;
+    typedef cv::Ptr<cv::freetype::FreeType2> FontHandle;
+
+    /**
+     * @param hotReload recarrega os assets quando o arquivo no disco muda.
+     * @param checkIntervalMs intervalo mínimo entre duas verificações do mesmo arquivo.
+     */
+    explicit AssetCache(bool hotReload = false, int checkIntervalMs = 500)
+        : hotReload(hotReload), checkInterval(checkIntervalMs) {}
+
+    /**
+     * @brief Imagem decodificada com imread(flags) e, se size não for vazio, redimensionada.
+     * @return handle nulo se o arquivo não pôde ser lido.
+     */
+    ImageHandle image(const std::string& path, cv::Size size = cv::Size(), int flags = cv::IMREAD_UNCHANGED) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Entry& entry = lookup("img", key(path, size) + "|" + std::to_string(flags), path);
+        if (entry.stale)
+            reload(entry, [&]() { return decode(path, size, flags); });
+        return std::static_pointer_cast<const cv::Mat>(entry.value);
+    }
+
+    /**
+     * @brief Sprite pré-multiplicado (ver sprite.hpp) feito a partir do PNG, no tamanho pedido.
+     * @return handle nulo se o arquivo não pôde ser lido.
+     */
+    SpriteHandle sprite(const std::string& path, cv::Size size = cv::Size()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Entry& entry = lookup("spr", key(path, size), path);
+        if (entry.stale) {
+            reload(entry, [&]() -> std::shared_ptr<const Sprite> {
+                std::shared_ptr<const cv::Mat> img = decode(path, size, cv::IMREAD_UNCHANGED);
+                if (!img)
+                    return nullptr;
+                return std::make_shared<const Sprite>(*img);
+            });
+        }
+        return std::static_pointer_cast<const Sprite>(entry.value);
+    }
+
+    /**
+     * @brief Fonte TrueType já carregada no FreeType, só para a thread que chama.
+     * @return ponteiro nulo se a fonte não pôde ser carregada.
+     */
+    FontHandle font(const std::string& path) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::string thread = std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+        Entry& entry = lookup("ttf", path + "|" + thread, path); // Uma instância por thread: o putText muda o FreeType2.
+        if (entry.stale) {
+            reload(entry, [&]() -> std::shared_ptr<cv::freetype::FreeType2> {
+                try {
+                    cv::Ptr<cv::freetype::FreeType2> ft2 = cv::freetype::createFreeType2();
+                    ft2->loadFontData(path, 0);
+                    return ft2;
+                } catch (const cv::Exception&) {
+                    return nullptr;
+                }
+            });
+        }
+        // Mutável para o putText; pode, porque a instância é só desta thread.
+        return std::const_pointer_cast<cv::freetype::FreeType2>(std::static_pointer_cast<const cv::freetype::FreeType2>(entry.value));
+    }
+
+    struct Stats {
+        size_t entries = 0; // Assets distintos no cache.
+        size_t loads = 0; // Leituras do disco (incluindo recargas).
+        size_t reloads = 0; // Recargas por mudança no arquivo.
+        size_t failures = 0; // Leituras que falharam.
+        size_t hits = 0; // Pedidos atendidos sem ler o disco.
+        double loadMs = 0; // Tempo total gasto carregando.
+        size_t residentBytes = 0; // Memória ocupada pelos pixels/fontes em cache.
+    };
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        Stats s = totals;
+        s.entries = entries.size();
+        for (const auto& item : entries)
+            s.residentBytes += item.second.bytes;
+        return s;
+    }
+
+    /** @brief Imprime uma linha por asset (tempo de carga e bytes) e o total. */
+    void printStats(std::ostream& out) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t resident = 0;
+        for (const auto& item : entries) {
+            out << "asset " << item.first << ": " << item.second.loadMs << " ms, "
+                << item.second.bytes << " bytes" << (item.second.value ? "" : " (falhou)") << std::endl;
+            resident += item.second.bytes;
+        }
+        out << "assets: " << entries.size() << " entradas, " << totals.loads << " cargas, "
+            << totals.reloads << " recargas, " << totals.hits << " acertos, "
+            << totals.loadMs << " ms carregando, " << resident << " bytes residentes" << std::endl;
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Entry {
+        std::string kind; // "img", "spr" ou "ttf".
+        std::string path; // Arquivo de origem.
+        std::shared_ptr<const void> value; // Handle entregue (Mat, Sprite ou FreeType2).
+        std::filesystem::file_time_type mtime; // Data do arquivo na última carga.
+        Clock::time_point lastCheck; // Última verificação da data.
+        bool stale = true; // Precisa (re)carregar.
+        bool loaded = false; // Já foi carregado alguma vez.
+        double loadMs = 0; // Tempo da última carga.
+        size_t bytes = 0; // Memória ocupada.
+    };
+
+    static std::string key(const std::string& path, cv::Size size) {
+        return path + "|" + std::to_string(size.width) + "x" + std::to_string(size.height);
+    }
+
+    static std::shared_ptr<const cv::Mat> decode(const std::string& path, cv::Size size, int flags) {
+        cv::Mat img = cv::imread(path, flags);
+        if (img.empty())
+            return nullptr;
+        if (size.width > 0 && size.height > 0 && img.size() != size)
+            cv::resize(img, img, size);
+        return std::make_shared<const cv::Mat>(img);
+    }
+
+    static size_t bytesOf(const Entry& entry) {
+        const std::shared_ptr<const void>& value = entry.value;
+        if (!value)
+            return 0;
+        if (entry.kind == "img") {
+            const cv::Mat& m = *std::static_pointer_cast<const cv::Mat>(value);
+            return m.total() * m.elemSize();
+        }
+        if (entry.kind == "spr") {
+            const Sprite& s = *std::static_pointer_cast<const Sprite>(value);
+            return s.color.total() * s.color.elemSize() + s.invAlpha.total() * s.invAlpha.elemSize()
+                 + s.alpha.total() * s.alpha.elemSize();
+        }
+        std::error_code error; // Fontes: o FreeType mantém o arquivo inteiro em memória.
+        uintmax_t size = std::filesystem::file_size(entry.path, error);
+        return error ? 0 : (size_t)size;
+    }
+
+    // Encontra (ou cria) a entrada e decide se ela precisa ser recarregada.
+    Entry& lookup(const std::string& kind, const std::string& k, const std::string& path) {
+        Entry& entry = entries[kind + "|" + k];
+        if (!entry.loaded) {
+            entry.kind = kind;
+            entry.path = path;
+            entry.stale = true;
+            return entry;
+        }
+        if (hotReload) {
+            Clock::time_point now = Clock::now();
+            if (now - entry.lastCheck >= checkInterval) {
+                entry.lastCheck = now;
+                std::error_code error;
+                std::filesystem::file_time_type mtime = std::filesystem::last_write_time(path, error);
+                if (!error && mtime != entry.mtime) {
+                    entry.stale = true;
+                    totals.reloads++;
+                }
+            }
+        }
+        if (!entry.stale)
+            totals.hits++;
+        return entry;
+    }
+
+    template <typename Loader>
+    void reload(Entry& entry, Loader load) {
+        int64_t start = cv::getTickCount();
+        std::shared_ptr<const void> value = load();
+        entry.loadMs = (cv::getTickCount() - start) * 1000.0 / cv::getTickFrequency();
+        std::error_code error;
+        entry.mtime = std::filesystem::last_write_time(entry.path, error);
+        entry.lastCheck = Clock::now();
+        entry.stale = false;
+        entry.loaded = true;
+        totals.loads++;
+        totals.loadMs += entry.loadMs;
+        if (!value) {
+            totals.failures++;
+            std::cerr << "Erro ao carregar " << entry.path << std::endl;
+        }
+        if (value || !entry.value) // Numa recarga que falhou, mantém a versão anterior.
+            entry.value = value;
+        entry.bytes = bytesOf(entry);
+    }
+
+    bool hotReload;
+    std::chrono::milliseconds checkInterval;
+    std::map<std::string, Entry> entries;
+    Stats totals;
+    mutable std::mutex mutex;
+};
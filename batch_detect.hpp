@@ -0,0 +1,302 @@
+#pragma once
+
+#include <opencv2/core.hpp> // Mat e Rect.
+#include <opencv2/imgproc.hpp> // resize, cvtColor e equalizeHist.
+#include <opencv2/videoio.hpp> // VideoCapture dos decodificadores.
+#include <algorithm> // std::sort, std::min, std::max.
+#include <atomic> // Contadores por vídeo.
+#include <chrono> // Tempo total do lote.
+#include <condition_variable> // Espera por vaga entre os quadros em trânsito.
+#include <cstdio> // snprintf das linhas da saída.
+#include <cstdlib> // atoi das opções.
+#include <filesystem> // Lista os vídeos de uma pasta.
+#include <fstream> // Arquivo de saída do modo lote.
+#include <map> // Detector de cada worker.
+#include <memory> // unique_ptr dos detectores e dos contadores.
+#include <mutex> // Saída e contagem dos quadros em trânsito.
+#include <ostream> // Saída dos resultados.
+#include <string> // Caminhos dos vídeos.
+#include <thread> // Threads dos decodificadores.
+#include <vector> // Vídeos, rostos e threads.
+#include "frame_pool.hpp" // Buffers dos quadros decodificados.
+#include "haar_detector.hpp" // Detector usado pelos workers.
+#include "thread_pool.hpp" // Workers da detecção, compartilhados por todos os vídeos.
+
+/** @brief Parâmetros do BatchDetector (os do detectAndDraw dos facedetect). */
+struct BatchDetectParams {
+    std::string cascade = "haarcascade_frontalface_default.xml";
+    double scale = 2; // Redução do quadro antes da detecção; as caixas voltam em coordenadas do quadro.
+    double scaleFactor = 1.3;
+    int minNeighbors = 2;
+    cv::Size minSize = cv::Size(40, 40); // Na imagem reduzida.
+    unsigned decoders = 0; // Vídeos decodificados ao mesmo tempo (0 = um para cada 4 workers).
+    unsigned maxInFlight = 0; // Quadros decodificados esperando ou em detecção (0 = 2 por worker).
+};
+
+/**
+ * @brief Detecção de rostos em lote sobre muitos vídeos, em paralelo.
+ *
+ * Cada decodificador (uma thread) pega o próximo vídeo da lista e lê os quadros dele
+ * em ordem; cada quadro vira uma tarefa no ThreadPool, cujos workers são comuns a todos
+ * os vídeos. Cada worker tem o seu HaarDetector (sem paralelismo interno: o paralelismo
+ * está nos quadros). Um decodificador só lê outro quadro quando há vaga entre os
+ * maxInFlight em trânsito, então a memória fica limitada mesmo que a decodificação seja
+ * mais rápida que a detecção.
+ *
+ * Os resultados são escritos assim que cada quadro termina, uma linha por quadro:
+ * video,quadro,rostos,caixas (caixas = "x y l a" separadas por '|'). Como os quadros
+ * terminam fora de ordem, a linha traz o vídeo e o número do quadro. Um quadro em que
+ * a detecção lança cv::Exception sai numa linha com rostos = "erro" e conta em failed.
+ */
+class BatchDetector {
+public:
+    /** @brief Resumo de um vídeo. */
+    struct ClipStats {
+        std::string path;
+        bool opened = false;
+        long frames = 0; // Quadros detectados.
+        long withFaces = 0; // Quadros com pelo menos um rosto.
+        long failed = 0; // Quadros em que a detecção falhou.
+        double fps = 0; // FPS do arquivo, para saber quanto tempo de gravação foi processado.
+    };
+
+    BatchDetector(ThreadPool& pool, const BatchDetectParams& params = BatchDetectParams()) : pool(pool), params(params) {}
+
+    /** @brief Vídeos de paths; pastas entram com todos os arquivos, em ordem alfabética. */
+    static std::vector<std::string> listClips(const std::vector<std::string>& paths) {
+        std::vector<std::string> clips;
+        for (const std::string& path : paths) {
+            if (!std::filesystem::is_directory(path)) {
+                clips.push_back(path);
+                continue;
+            }
+            std::vector<std::string> files;
+            for (const auto& entry : std::filesystem::directory_iterator(path))
+                if (entry.is_regular_file())
+                    files.push_back(entry.path().string());
+            std::sort(files.begin(), files.end());
+            clips.insert(clips.end(), files.begin(), files.end());
+        }
+        return clips;
+    }
+
+    /**
+     * @brief Processa todos os vídeos, escrevendo as linhas em out à medida que saem.
+     * @return resumo de cada vídeo, na ordem de clips (arquivos que não abrem ficam com opened = false).
+     */
+    std::vector<ClipStats> run(const std::vector<std::string>& clips, std::ostream& out) {
+        unsigned workers = std::max(pool.size() - 1, 1u); // Quem chama não executa tarefas aqui.
+        unsigned decoders = params.decoders ? params.decoders : std::max(1u, workers / 4);
+        decoders = std::min(decoders, (unsigned)std::max<size_t>(clips.size(), 1));
+        maxInFlight = params.maxInFlight ? params.maxInFlight : 2 * workers;
+        output = &out;
+        nextClip = 0;
+        inFlight = 0;
+        counters.clear();
+        for (size_t i = 0; i < clips.size(); i++)
+            counters.emplace_back(new Counters);
+        std::vector<ClipStats> stats(clips.size());
+        for (size_t i = 0; i < clips.size(); i++)
+            stats[i].path = clips[i];
+
+        out << "video,quadro,rostos,caixas\n";
+        std::vector<std::thread> threads;
+        for (unsigned d = 0; d < decoders; d++)
+            threads.emplace_back([this, &clips, &stats]() { decodeLoop(clips, stats); });
+        for (std::thread& t : threads)
+            t.join();
+        {
+            std::unique_lock<std::mutex> lock(flightMutex); // Espera os últimos quadros.
+            slotFree.wait(lock, [this]() { return inFlight == 0; });
+        }
+        out.flush();
+        for (size_t i = 0; i < clips.size(); i++) {
+            stats[i].frames = counters[i]->frames;
+            stats[i].withFaces = counters[i]->withFaces;
+            stats[i].failed = counters[i]->failed;
+        }
+        return stats;
+    }
+
+private:
+    struct Counters {
+        std::atomic<long> frames{ 0 };
+        std::atomic<long> withFaces{ 0 };
+        std::atomic<long> failed{ 0 };
+    };
+
+    // Devolve a vaga do quadro ao sair da tarefa, mesmo que ela lance.
+    struct SlotGuard {
+        BatchDetector& batch;
+        ~SlotGuard() {
+            batch.releaseSlot();
+        }
+    };
+
+    // Um decodificador: pega vídeos da lista até acabarem.
+    void decodeLoop(const std::vector<std::string>& clips, std::vector<ClipStats>& stats) {
+        FramePool frames(maxInFlight + 2); // Os buffers voltam quando a detecção solta o quadro.
+        for (;;) {
+            size_t clip = nextClip.fetch_add(1);
+            if (clip >= clips.size())
+                return;
+            cv::VideoCapture cap(clips[clip]);
+            if (!cap.isOpened())
+                continue;
+            stats[clip].opened = true;
+            stats[clip].fps = cap.get(cv::CAP_PROP_FPS);
+            cv::Mat frame;
+            cv::Size size;
+            for (long index = 0;; index++) {
+                frame.release();
+                if (!size.empty())
+                    frame = frames.acquire(size, CV_8UC3); // A leitura escreve no buffer reaproveitado.
+                if (!cap.read(frame) || frame.empty())
+                    break;
+                size = frame.size();
+                acquireSlot(); // Back-pressure: espera a detecção abrir vaga.
+                pool.submit([this, frame, clip, index, &clips]() { detect(frame, clips[clip], clip, index); });
+            }
+        }
+    }
+
+    void acquireSlot() {
+        std::unique_lock<std::mutex> lock(flightMutex);
+        slotFree.wait(lock, [this]() { return inFlight < maxInFlight; });
+        inFlight++;
+    }
+
+    void releaseSlot() {
+        {
+            std::lock_guard<std::mutex> lock(flightMutex);
+            inFlight--;
+        }
+        slotFree.notify_all();
+    }
+
+    // Detector do worker que chama (o HaarDetector guarda buffers por frame), carregado no primeiro quadro dele.
+    HaarDetector& workerDetector() {
+        std::lock_guard<std::mutex> lock(detectorsMutex);
+        std::unique_ptr<HaarDetector>& detector = detectors[std::this_thread::get_id()];
+        if (!detector) {
+            detector.reset(new HaarDetector(nullptr));
+            detector->loadPreferCompiled(params.cascade);
+        }
+        return *detector;
+    }
+
+    // Tarefa de um quadro, num worker do pool.
+    void detect(const cv::Mat& frame, const std::string& path, size_t clip, long index) {
+        SlotGuard slot{ *this };
+        try {
+            detectFrame(frame, path, clip, index);
+        } catch (const cv::Exception& e) { // Não derruba o worker: o quadro fica marcado e o lote continua.
+            char field[64];
+            std::snprintf(field, sizeof(field), ",%ld,erro,\n", index);
+            {
+                std::lock_guard<std::mutex> lock(outputMutex);
+                *output << path << field;
+            }
+            std::fprintf(stderr, "%s, quadro %ld: %s\n", path.c_str(), index, e.what());
+            counters[clip]->failed++;
+        }
+    }
+
+    void detectFrame(const cv::Mat& frame, const std::string& path, size_t clip, long index) {
+        thread_local cv::Mat small, gray; // Só buffers de trabalho; o detector vem de workerDetector().
+        thread_local std::vector<cv::Rect> faces;
+        HaarDetector& detector = workerDetector();
+        double fx = 1 / params.scale;
+        cv::resize(frame, small, cv::Size(), fx, fx, cv::INTER_LINEAR_EXACT);
+        cv::cvtColor(small, gray, cv::COLOR_BGR2GRAY);
+        cv::equalizeHist(gray, gray);
+        detector.detectMultiScale(gray, faces, params.scaleFactor, params.minNeighbors, 0, params.minSize);
+
+        std::string line = path;
+        char field[64];
+        std::snprintf(field, sizeof(field), ",%ld,%zu,", index, faces.size());
+        line += field;
+        for (size_t i = 0; i < faces.size(); i++) { // Caixas em coordenadas do quadro original.
+            const cv::Rect& r = faces[i];
+            std::snprintf(field, sizeof(field), "%s%d %d %d %d", i ? "|" : "", cvRound(r.x * params.scale),
+                          cvRound(r.y * params.scale), cvRound(r.width * params.scale), cvRound(r.height * params.scale));
+            line += field;
+        }
+        line += '\n';
+        {
+            std::lock_guard<std::mutex> lock(outputMutex);
+            *output << line;
+        }
+        counters[clip]->frames++;
+        counters[clip]->withFaces += !faces.empty();
+    }
+
+    ThreadPool& pool;
+    BatchDetectParams params;
+    std::ostream* output = nullptr;
+    std::mutex outputMutex;
+    std::vector<std::unique_ptr<Counters>> counters; // Um por vídeo.
+    std::map<std::thread::id, std::unique_ptr<HaarDetector>> detectors; // Um por worker, com o cascade deste lote.
+    std::mutex detectorsMutex;
+    std::atomic<size_t> nextClip{ 0 };
+    unsigned maxInFlight = 0;
+    unsigned inFlight = 0; // Quadros entregues ao pool e ainda não terminados.
+    std::mutex flightMutex;
+    std::condition_variable slotFree;
+};
+
+/**
+ * @brief Modo lote dos programas de detecção:
+ * ./a.out --batch saida.csv [--decoders N] [--in-flight N] video1.mp4 video2.mp4 pasta/ ...
+ * @return código de saída do programa.
+ */
+inline int batchMain(int argc, const char** argv) {
+    if (argc < 4) {
+        std::printf("Uso: %s --batch saida.csv [--decoders N] [--in-flight N] videos|pastas...\n", argv[0]);
+        return -1;
+    }
+    BatchDetectParams params;
+    std::vector<std::string> inputs;
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--decoders" && i + 1 < argc)
+            params.decoders = (unsigned)std::atoi(argv[++i]);
+        else if (arg == "--in-flight" && i + 1 < argc)
+            params.maxInFlight = (unsigned)std::atoi(argv[++i]);
+        else
+            inputs.push_back(arg);
+    }
+    HaarDetector check(nullptr);
+    if (!check.loadPreferCompiled(params.cascade)) {
+        std::printf("Erro ao carregar o classificador %s\n", params.cascade.c_str());
+        return -1;
+    }
+    std::ofstream out(argv[2]);
+    if (!out) {
+        std::printf("Erro ao criar %s\n", argv[2]);
+        return -1;
+    }
+
+    std::vector<std::string> clips = BatchDetector::listClips(inputs);
+    BatchDetector batch(ThreadPool::shared(), params);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<BatchDetector::ClipStats> stats = batch.run(clips, out);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    long frames = 0, failed = 0;
+    double footage = 0; // Segundos de gravação processados.
+    for (const BatchDetector::ClipStats& s : stats) {
+        if (!s.opened) {
+            std::printf("%s: não abriu\n", s.path.c_str());
+            continue;
+        }
+        std::printf("%s: %ld quadros, %ld com rosto", s.path.c_str(), s.frames, s.withFaces);
+        std::printf(s.failed ? ", %ld com erro\n" : "\n", s.failed);
+        frames += s.frames;
+        failed += s.failed;
+        footage += s.fps > 0 ? s.frames / s.fps : 0;
+    }
+    std::printf("%ld quadros em %.1f s (%.0f quadros/s, %.1fx o tempo real) com %u threads\n", frames, seconds,
+                seconds > 0 ? frames / seconds : 0, seconds > 0 ? footage / seconds : 0, ThreadPool::shared().size());
+    return out && failed == 0 ? 0 : 1;
+}
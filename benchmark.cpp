@@ -0,0 +1,794 @@
+#include <opencv2/opencv.hpp> // Inclui a biblioteca OpenCV para manipulação de imagens e vídeos.
+#include <iostream> // Inclui a biblioteca de entrada/saída padrão do C++.
+#include <vector> // Inclui a biblioteca para usar vetores dinâmicos.
+#include <string> // Inclui a classe string.
+#include <cstdio> // Inclui printf para a tabela de resultados.
+#include <opencv2/freetype.hpp> // Inclui suporte para renderização de texto com FreeType.
+#include "sprite.hpp" // Sprites pré-multiplicados e o desenho com transparência.
+#include "text_renderer.hpp" // Texto com glifos em cache.
+#include "face_tracker.hpp" // Detecção com rastreamento por janela.
+#include "haar_detector.hpp" // Cascade Haar paralelo com pirâmide de integrais.
+#include "collision_grid.hpp" // Broad phase de colisão com grade uniforme.
+#include "collision_mask.hpp" // Colisão por pixel com máscaras de bits.
+#include "compositing.hpp" // Escurecimento, retângulo transparente e vinheta no próprio quadro.
+#include "compositor.hpp" // Tela em camadas com retângulos sujos.
+#include "snake_board.hpp" // Tabuleiro da cobrinha com grade de ocupação.
+#include <random> // Posições das entidades do teste de colisão.
+#include <algorithm> // Ordena os tempos para os percentis.
+#include <cmath> // hypot.
+#include <fstream> // VmRSS de /proc/self/status.
+
+using namespace cv;
+using namespace std;
+
+// Versão antiga do desenho de imagens (split/merge/copyTo com máscara), mantida só para comparação.
+void drawImageLegacy(Mat frame, Mat img, int xPos, int yPos) {
+    if (yPos + img.rows >= frame.rows || xPos + img.cols >= frame.cols || yPos < 0 || xPos < 0)
+        return;
+
+    Mat mask;
+    vector<Mat> layers;
+
+    split(img, layers);
+    if (layers.size() == 4) {
+        Mat rgb[3] = { layers[0], layers[1], layers[2] };
+        mask = layers[3];
+        merge(rgb, 3, img);
+        img.copyTo(frame.rowRange(yPos, yPos + img.rows).colRange(xPos, xPos + img.cols), mask);
+    } else {
+        img.copyTo(frame.rowRange(yPos, yPos + img.rows).colRange(xPos, xPos + img.cols));
+    }
+}
+
+// Mede o tempo médio (em microssegundos) de uma chamada de func, repetida iterations vezes.
+template <typename F>
+double timeMicros(int iterations, F func) {
+    func(0); // Aquecimento.
+    int64 start = getTickCount();
+    for (int i = 0; i < iterations; i++)
+        func(i);
+    return (getTickCount() - start) * 1e6 / getTickFrequency() / iterations;
+}
+
+// Compara drawImage (antigo) com drawSprite (novo) para sprites 80x80 e 100x100.
+void benchSprite() {
+    const int iterations = 20000; // Número de desenhos por medição.
+    Mat frame(720, 1280, CV_8UC3, Scalar(40, 80, 120)); // Quadro de destino, do tamanho de uma câmera 720p.
+    const char* files[] = { "nave.png", "target.png" }; // Sprites usados no jogo.
+    const int sizes[] = { 80, 100 }; // Tamanhos usados no jogo.
+
+    printf("%-12s %-8s %14s %14s %8s\n", "sprite", "tamanho", "drawImage(us)", "drawSprite(us)", "ganho");
+    for (const char* file : files) {
+        Mat img = imread(file, IMREAD_UNCHANGED);
+        if (img.empty()) {
+            cout << "Erro ao carregar " << file << endl;
+            continue;
+        }
+        for (int side : sizes) {
+            Mat resized;
+            resize(img, resized, Size(side, side));
+            Sprite sprite(resized);
+            // As posições variam para não medir sempre a mesma região em cache.
+            double legacy = timeMicros(iterations, [&](int i) {
+                drawImageLegacy(frame, resized, (i * 37) % (frame.cols - side - 1), (i * 53) % (frame.rows - side - 1));
+            });
+            double current = timeMicros(iterations, [&](int i) {
+                drawSprite(frame, sprite, (i * 37) % (frame.cols - side - 1), (i * 53) % (frame.rows - side - 1));
+            });
+            printf("%-12s %3dx%-4d %14.2f %14.2f %7.1fx\n", file, side, side, legacy, current, legacy / current);
+        }
+    }
+}
+
+// Custo do HUD por frame: pontuação (muda a cada 30 frames) e a mensagem de fase.
+void benchHud() {
+    const int frames = 2000; // Frames simulados.
+    Mat frame(720, 1280, CV_8UC3, Scalar(40, 80, 120)); // Quadro de destino.
+    Ptr<freetype::FreeType2> ft2 = freetype::createFreeType2();
+    ft2->loadFontData("arcadeclassic.ttf", 0);
+    Scalar color(255, 255, 255);
+
+    // Caminho antigo: getTextSize + putText do FreeType a cada frame, como em drawScore()/displayMessage().
+    double legacy = timeMicros(frames, [&](int i) {
+        int score = (i / 30) * 100;
+        int baseline = 0;
+        Size textSize = ft2->getTextSize(to_string(score), 30, LINE_AA, &baseline);
+        ft2->putText(frame, "SCORE: " + to_string(score), Point(10, textSize.height + 10), 30, color, cv::FILLED, LINE_AA, true);
+        textSize = ft2->getTextSize("FASE 2", 80, LINE_AA, &baseline);
+        ft2->putText(frame, "FASE 2", Point((frame.cols - textSize.width) / 2, (frame.rows + textSize.height) / 2), 80, color, cv::FILLED, LINE_AA, true);
+    });
+
+    int64 start = getTickCount();
+    TextRenderer hudText(ft2, 30); // Inclui o custo de montar os atlas, que é pago uma vez.
+    TextRenderer bigText(ft2, 80);
+    double setupMs = (getTickCount() - start) * 1000.0 / getTickFrequency();
+    double cached = timeMicros(frames, [&](int i) {
+        int score = (i / 30) * 100;
+        Size textSize = hudText.textSize(to_string(score));
+        hudText.draw(frame, "SCORE: " + to_string(score), Point(10, textSize.height + 10), color);
+        textSize = bigText.textSize("FASE 2");
+        bigText.draw(frame, "FASE 2", Point((frame.cols - textSize.width) / 2, (frame.rows + textSize.height) / 2), color);
+    });
+
+    printf("HUD por frame: FreeType %.1f us, TextRenderer %.1f us (%.1fx), atlas montado em %.1f ms\n",
+           legacy, cached, legacy / cached, setupMs);
+}
+
+// Interseção sobre união de dois retângulos (0 = disjuntos, 1 = iguais).
+double iou(const Rect& a, const Rect& b) {
+    double inter = (a & b).area();
+    double uni = a.area() + b.area() - inter;
+    return uni > 0 ? inter / uni : 0;
+}
+
+// Compara detectMultiScale no quadro inteiro com o FaceTracker, em 720p, sobre um vídeo gravado.
+void benchTracker(const string& video) {
+    CascadeClassifier cascade;
+    if (!cascade.load("haarcascade_frontalface_default.xml")) {
+        cout << "Erro ao carregar o classificador de rosto!" << endl;
+        return;
+    }
+    VideoCapture cap(video);
+    if (!cap.isOpened()) {
+        cout << "Erro ao abrir " << video << endl;
+        return;
+    }
+
+    FaceTrackerParams params; // Os mesmos parâmetros do teste.cpp.
+    params.scaleFactor = 1.5;
+    params.minNeighbors = 2;
+    params.flags = CASCADE_SCALE_IMAGE;
+    params.minSize = Size(50, 50);
+    FaceTracker tracker(cascade, params);
+
+    Mat frame, resized, gray;
+    vector<Rect> full, tracked;
+    double fullMs = 0;
+    int frames = 0, bothFound = 0, agree = 0, fullOnly = 0, trackedOnly = 0;
+    while (cap.read(frame)) {
+        resize(frame, resized, Size(1280, 720));
+        cvtColor(resized, gray, COLOR_BGR2GRAY);
+        equalizeHist(gray, gray);
+
+        int64 start = getTickCount();
+        cascade.detectMultiScale(gray, full, params.scaleFactor, params.minNeighbors, params.flags, params.minSize);
+        fullMs += (getTickCount() - start) * 1000.0 / getTickFrequency();
+        tracker.detect(gray, tracked);
+
+        frames++;
+        if (!full.empty() && !tracked.empty()) {
+            bothFound++;
+            double best = 0; // O rosto rastreado deve bater com algum dos rostos da busca completa.
+            for (const Rect& r : full)
+                best = max(best, iou(r, tracked[0]));
+            agree += best > 0.5;
+        } else if (!full.empty()) {
+            fullOnly++;
+        } else if (!tracked.empty()) {
+            trackedOnly++;
+        }
+    }
+    if (frames == 0)
+        return;
+
+    const FaceTracker::Stats& stats = tracker.statistics();
+    printf("%d frames 720p: quadro inteiro %.2f ms/frame, FaceTracker %.2f ms/frame (%.1fx)\n",
+           frames, fullMs / frames, stats.totalMs / frames, fullMs / max(stats.totalMs, 1e-9));
+    printf("buscas completas %ld, na janela %ld (%ld falhas); concordância IoU>0.5 em %d de %d frames com rosto nos dois; "
+           "só quadro inteiro %d, só tracker %d\n",
+           stats.fullScans, stats.roiScans, stats.misses, agree, bothFound, fullOnly, trackedOnly);
+}
+
+// Detecção reduzida (ScaledFaceTracker) em várias escalas contra a resolução cheia, num vídeo gravado em 720p:
+// tempo por frame, rostos achados, IoU com a resolução cheia e o tremor do centro entre frames.
+void benchDetectScale(const string& video) {
+    HaarDetector detector;
+    if (!detector.load("haarcascade_frontalface_default.xml")) {
+        cout << "Erro ao carregar o classificador de rosto!" << endl;
+        return;
+    }
+    FaceTrackerParams params; // Os mesmos parâmetros do teste.cpp.
+    params.scaleFactor = 1.5;
+    params.minNeighbors = 2;
+    params.flags = CASCADE_SCALE_IMAGE;
+    params.minSize = Size(50, 50);
+
+    struct Config {
+        const char* name;
+        double scale;
+        double budgetMs;
+    };
+    const Config configs[] = { { "1 (referencia)", 1, 0 }, { "1.5", 1.5, 0 }, { "2", 2, 0 }, { "3", 3, 0 }, { "4", 4, 0 },
+                               { "auto 4 ms", 1, 4 } };
+    vector<Rect> reference; // Rosto da resolução cheia em cada frame (vazio = nenhum).
+    printf("%-16s %10s %10s %10s %10s %12s %8s\n", "escala", "media(ms)", "p95(ms)", "achados", "IoU medio", "tremor(px)",
+           "final");
+    for (const Config& config : configs) {
+        VideoCapture cap(video);
+        if (!cap.isOpened()) {
+            cout << "Erro ao abrir " << video << endl;
+            return;
+        }
+        DetectionScaleParams scaling;
+        scaling.scale = config.scale;
+        scaling.budgetMs = config.budgetMs;
+        scaling.equalize = true;
+        ScaledFaceTracker tracker(detector, params, scaling);
+        Mat frame, resized, gray;
+        vector<Rect> faces;
+        vector<double> times;
+        double iouSum = 0, jitter = 0;
+        int found = 0, compared = 0, moves = 0;
+        Point prevCenter(-1, -1);
+        for (int i = 0; cap.read(frame); i++) {
+            resize(frame, resized, Size(1280, 720));
+            cvtColor(resized, gray, COLOR_BGR2GRAY);
+            tracker.detect(gray, faces);
+            times.push_back(tracker.lastDetectionMs());
+            Rect face = faces.empty() ? Rect() : faces[0];
+            if (config.scale == 1 && config.budgetMs == 0)
+                reference.push_back(face);
+            if (faces.empty()) {
+                prevCenter = Point(-1, -1);
+                continue;
+            }
+            found++;
+            if (i < (int)reference.size() && !reference[i].empty()) {
+                iouSum += iou(face, reference[i]);
+                compared++;
+            }
+            Point center(face.x + face.width / 2, face.y + face.height / 2);
+            if (prevCenter.x >= 0) {
+                jitter += hypot(center.x - prevCenter.x, center.y - prevCenter.y);
+                moves++;
+            }
+            prevCenter = center;
+        }
+        if (times.empty())
+            return;
+        double total = 0;
+        for (double t : times)
+            total += t;
+        sort(times.begin(), times.end());
+        printf("%-16s %10.2f %10.2f %9.0f%% %10.2f %12.2f %8.2f\n", config.name, total / times.size(),
+               times[(size_t)(times.size() * 0.95)], 100.0 * found / times.size(), compared ? iouSum / compared : 0,
+               moves ? jitter / moves : 0, tracker.currentScale());
+    }
+}
+
+// Compara o CascadeClassifier do OpenCV com o HaarDetector (mesmos parâmetros do teste.cpp) em 720p.
+void benchHaar(const string& video) {
+    const char* files[] = { "haarcascade_frontalface_default.xml", "hand.xml" };
+    for (const char* file : files) {
+        HaarDetector haar(nullptr);
+        if (!haar.load(file)) {
+            cout << "Erro ao carregar " << file << endl;
+            continue;
+        }
+        const HaarCascade& data = haar.cascade();
+        printf("%s: %d estagios, %d classificadores fracos%s\n", file, (int)data.stageThreshold.size(),
+               data.weakCount(), data.hasTilted ? ", com features inclinadas" : "");
+    }
+
+    CascadeClassifier cascade;
+    HaarDetector pooled, single(nullptr);
+    if (!cascade.load("haarcascade_frontalface_default.xml") || !pooled.load("haarcascade_frontalface_default.xml")
+        || !single.load("haarcascade_frontalface_default.xml")) {
+        cout << "Erro ao carregar o classificador de rosto!" << endl;
+        return;
+    }
+    VideoCapture cap(video);
+    if (!cap.isOpened()) {
+        cout << "Erro ao abrir " << video << endl;
+        return;
+    }
+
+    Mat frame, resized, gray;
+    vector<Rect> expected, found;
+    double opencvMs = 0, pooledMs = 0, singleMs = 0;
+    int frames = 0, expectedFaces = 0, matched = 0, extra = 0;
+    while (cap.read(frame)) {
+        resize(frame, resized, Size(1280, 720));
+        cvtColor(resized, gray, COLOR_BGR2GRAY);
+        equalizeHist(gray, gray);
+
+        int64 start = getTickCount();
+        cascade.detectMultiScale(gray, expected, 1.5, 2, CASCADE_SCALE_IMAGE, Size(50, 50));
+        opencvMs += (getTickCount() - start) * 1000.0 / getTickFrequency();
+
+        start = getTickCount();
+        single.detectMultiScale(gray, found, 1.5, 2, CASCADE_SCALE_IMAGE, Size(50, 50));
+        singleMs += (getTickCount() - start) * 1000.0 / getTickFrequency();
+
+        start = getTickCount();
+        pooled.detectMultiScale(gray, found, 1.5, 2, CASCADE_SCALE_IMAGE, Size(50, 50));
+        pooledMs += (getTickCount() - start) * 1000.0 / getTickFrequency();
+
+        frames++;
+        expectedFaces += (int)expected.size();
+        for (const Rect& r : expected) { // Cada rosto do OpenCV deve ter um correspondente no HaarDetector.
+            double best = 0;
+            for (const Rect& f : found)
+                best = max(best, iou(r, f));
+            matched += best > 0.5;
+        }
+        extra += max(0, (int)found.size() - (int)expected.size());
+    }
+    if (frames == 0)
+        return;
+
+    printf("%d frames 720p: OpenCV %.2f ms/frame, HaarDetector 1 thread %.2f ms/frame, %u threads %.2f ms/frame (%.1fx)\n",
+           frames, opencvMs / frames, singleMs / frames, ThreadPool::shared().size(), pooledMs / frames,
+           opencvMs / max(pooledMs, 1e-9));
+    printf("rostos do OpenCV encontrados (IoU>0.5): %d de %d; rostos a mais no HaarDetector: %d\n",
+           matched, expectedFaces, extra);
+}
+
+// Janelas por segundo do HaarDetector (uma thread) em um quadro fixo de 640x480, para cada kernel,
+// cortando o cascade em 1, 2, ... estágios. Saída no formato do Google Benchmark.
+void benchKernel(const string& video) {
+    HaarDetector haar(nullptr);
+    if (!haar.load("haarcascade_frontalface_default.xml")) {
+        cout << "Erro ao carregar o classificador de rosto!" << endl;
+        return;
+    }
+    Mat frame, gray;
+    VideoCapture cap(video);
+    if (cap.isOpened() && cap.read(frame)) {
+        resize(frame, frame, Size(640, 480));
+        cvtColor(frame, gray, COLOR_BGR2GRAY);
+        equalizeHist(gray, gray);
+    } else { // Sem vídeo: ruído com semente fixa, sempre o mesmo quadro.
+        gray.create(480, 640, CV_8UC1);
+        RNG rng(12345);
+        rng.fill(gray, RNG::UNIFORM, 0, 256);
+    }
+
+    const HaarKernel kernels[] = { HaarKernel::Scalar, HaarKernel::SSE2, HaarKernel::AVX2 };
+    int stages = (int)haar.cascade().stageThreshold.size();
+    vector<Rect> found;
+    printf("%-32s %12s %12s %14s\n", "Benchmark", "Time", "Iterations", "windows/s");
+    printf("%s\n", string(73, '-').c_str());
+    for (int stage = 1; stage <= stages; stage++) {
+        for (HaarKernel kernel : kernels) {
+            if (!haar.setKernel(kernel))
+                continue;
+            haar.setStageLimit(stage);
+            haar.detectMultiScale(gray, found, 1.1, 0); // Aquecimento.
+            int iterations = 0;
+            double seconds = 0;
+            int64 start = getTickCount();
+            while (seconds < 0.2 || iterations < 3) { // Repete até ter pelo menos 0,2 s de medição.
+                haar.detectMultiScale(gray, found, 1.1, 0);
+                iterations++;
+                seconds = (getTickCount() - start) / getTickFrequency();
+            }
+            string name = string("BM_HaarKernel/") + haarKernelName(kernel) + "/stages:" + to_string(stage);
+            printf("%-32s %9.3f ms %12d %13.1fM\n", name.c_str(), seconds * 1000 / iterations, iterations,
+                   haar.windowCount() * (double)iterations / seconds / 1e6);
+        }
+    }
+    printf("(%ld janelas por quadro; kernel escolhido em tempo de execucao: %s)\n", haar.windowCount(),
+           haarKernelName(bestHaarKernel()));
+}
+
+// Colisão tiros x alvos com 10, 1k e 10k entidades: todos os pares contra a grade uniforme.
+// A área cresce com o número de entidades (mesma densidade do jogo), então a grade deve escalar quase linearmente.
+void benchCollision() {
+    const float targetSide = 100, shotW = 20, shotH = 10; // Tamanhos dos sprites do jogo.
+    const int counts[] = { 10, 1000, 10000 };
+    printf("%-10s %14s %14s %10s %12s %8s\n", "entidades", "pares(us)", "grade(us)", "ganho", "grade/ent(ns)", "acertos");
+    for (int n : counts) {
+        EntityStore e;
+        mt19937 rng(42);
+        float side = 1280 * sqrt(n / 20.0f); // Uns 20 objetos num quadro de 1280x1280, como na tela do jogo.
+        uniform_real_distribution<float> pos(0, side);
+        for (int i = 0; i < n; i++) // Metade alvos, metade tiros.
+            e.spawn(i % 2 ? EntityType::Shot : EntityType::Target, pos(rng), pos(rng), 0, i % 2 ? -7.5f : 4.0f);
+
+        int iterations = max(3, 200000 / n);
+        long bruteHits = 0, gridHits = 0;
+        vector<uint32_t> shots, targets;
+        for (size_t i = 0; i < e.size(); i++)
+            (e.type[i] == EntityType::Shot ? shots : targets).push_back((uint32_t)i);
+        double brute = timeMicros(max(1, iterations / (n / 1000 + 1)), [&](int) {
+            bruteHits = 0;
+            for (uint32_t i : shots)
+                for (uint32_t j : targets)
+                    bruteHits += rectsOverlap(e.x[i], e.y[i], shotW, shotH, e.x[j], e.y[j], targetSide, targetSide);
+        });
+        CollisionGrid grid(targetSide);
+        double gridded = timeMicros(iterations, [&](int) {
+            gridHits = 0;
+            grid.build(e, EntityType::Target, targetSide, targetSide); // Remontada a cada tick, como no jogo.
+            for (uint32_t i : shots)
+                grid.query(e.x[i], e.y[i], shotW, shotH, [&](size_t j) {
+                    gridHits += rectsOverlap(e.x[i], e.y[i], shotW, shotH, e.x[j], e.y[j], targetSide, targetSide);
+                    return true;
+                });
+        });
+        printf("%-10d %14.1f %14.1f %9.1fx %12.1f %8ld%s\n", n, brute, gridded, brute / gridded, gridded * 1000 / n,
+               gridHits, gridHits == bruteHits ? "" : "  (diferente do teste de todos os pares!)");
+    }
+}
+
+// Narrow phase nave x alvo: máscaras de bits contra o teste com Mats (AND dos alfas + countNonZero),
+// e a conferência das duas respostas em deslocamentos sorteados.
+void benchMask() {
+    Mat naveImg = imread("nave.png", IMREAD_UNCHANGED), targetImg = imread("target.png", IMREAD_UNCHANGED);
+    if (naveImg.empty() || targetImg.empty()) {
+        cout << "Erro ao carregar nave.png ou target.png" << endl;
+        return;
+    }
+    resize(naveImg, naveImg, Size(80, 80)); // Tamanhos usados no jogo.
+    resize(targetImg, targetImg, Size(100, 100));
+    Sprite nave(naveImg), target(targetImg);
+    CollisionMask naveMask(nave), targetMask(target);
+    const int iterations = 100000;
+    // Deslocamentos do alvo em relação à nave dentro da faixa em que os retângulos se tocam.
+    auto offset = [](int i, int range) { return (i * 7919) % (2 * range + 1) - range; };
+
+    int matHits = 0, maskHits = 0;
+    Mat overlap;
+    double matTime = timeMicros(iterations / 10, [&](int i) {
+        int dx = offset(i, 99), dy = offset(i / 3, 99);
+        Rect a(0, 0, 80, 80), b(dx, dy, 100, 100);
+        Rect inter = a & b;
+        if (inter.area() == 0)
+            return;
+        Mat alphaA = nave.alpha(inter), alphaB = target.alpha(inter - b.tl());
+        bitwise_and(alphaA >= 128, alphaB >= 128, overlap);
+        matHits += countNonZero(overlap) > 0;
+    });
+    double maskTime = timeMicros(iterations, [&](int i) {
+        maskHits += masksOverlap(naveMask, 0, 0, targetMask, offset(i, 99), offset(i / 3, 99));
+    });
+    printf("Colisao nave x alvo por pixel: Mat %.3f us, mascara de bits %.3f us (%.0fx)\n", matTime, maskTime,
+           matTime / maskTime);
+
+    // Conferência: masksOverlap contra o teste pixel a pixel nos mesmos deslocamentos sorteados, incluindo
+    // negativos, retângulos disjuntos e máscaras mais largas que 64 px (uma palavra por linha).
+    auto solid = [](const Sprite& sprite) { // Pixels sólidos, com a mesma regra da máscara (alfa >= 128).
+        return sprite.opaque() ? Mat(sprite.rows, sprite.cols, CV_8UC1, Scalar(255)) : Mat(sprite.alpha >= 128);
+    };
+    Mat wideImg;
+    resize(targetImg, wideImg, Size(200, 70));
+    Sprite wide(wideImg);
+    const Sprite* pairs[][2] = { { &nave, &target }, { &target, &wide }, { &wide, &nave } };
+    const int cases = 20000;
+    RNG rng(13);
+    int checked = 0, mismatches = 0;
+    for (const auto& pair : pairs) {
+        const Sprite &a = *pair[0], &b = *pair[1];
+        CollisionMask maskA(a), maskB(b);
+        Mat solidA = solid(a), solidB = solid(b);
+        for (int i = 0; i < cases; i++) {
+            int ax = rng.uniform(-150, 150), ay = rng.uniform(-150, 150), bx = rng.uniform(-150, 150), by = rng.uniform(-150, 150);
+            Rect inter = Rect(ax, ay, a.cols, a.rows) & Rect(bx, by, b.cols, b.rows);
+            bool expected = false;
+            if (inter.area() > 0) {
+                bitwise_and(solidA(inter - Point(ax, ay)), solidB(inter - Point(bx, by)), overlap);
+                expected = countNonZero(overlap) > 0;
+            }
+            mismatches += masksOverlap(maskA, ax, ay, maskB, bx, by) != expected;
+            checked++;
+        }
+    }
+    printf("Conferencia com o teste pixel a pixel: %d casos%s\n", checked,
+           mismatches ? format("  (%d diferentes do teste pixel a pixel!)", mismatches).c_str() : "");
+}
+
+// Efeitos de tela em 1080p: as funções antigas (com Mats temporários) contra os kernels de compositing.hpp,
+// e a conferência dos limites de erro que o cabeçalho promete.
+void benchCompositing() {
+    const int iterations = 200;
+    Mat source(1080, 1920, CV_8UC3);
+    RNG rng(7);
+    rng.fill(source, RNG::UNIFORM, 0, 256);
+    Mat frame = source.clone();
+    printf("%-28s %14s %14s %8s\n", "efeito (1920x1080)", "antigo(us)", "novo(us)", "ganho");
+
+    // displayMessage(): sobreposição preta + setTo + addWeighted.
+    double legacy = timeMicros(iterations, [&](int) {
+        Mat overlay = Mat::zeros(frame.size(), frame.type());
+        overlay.setTo(Scalar(0, 0, 0));
+        addWeighted(overlay, 0.5, frame, 0.5, 0, frame);
+    });
+    double current = timeMicros(iterations, [&](int) { scaleInPlace(frame, 0.5); });
+    printf("%-28s %14.1f %14.1f %7.1fx\n", "escurecer 50%", legacy, current, legacy / current);
+
+    // drawTransRect(): Mat da cor do tamanho do retângulo + addWeighted.
+    const Rect regions[] = { Rect(0, 0, 200, 200), Rect(0, 0, 1920, 1080) };
+    for (const Rect& region : regions) {
+        legacy = timeMicros(iterations, [&](int) {
+            Mat roi = frame(region);
+            Mat rectImg(roi.size(), CV_8UC3, Scalar(0, 255, 0));
+            addWeighted(rectImg, 0.7, roi, 0.3, 0, roi);
+        });
+        current = timeMicros(iterations, [&](int) { blendColorRect(frame, region, Scalar(0, 255, 0), 0.7); });
+        string name = "retangulo " + to_string(region.width) + "x" + to_string(region.height);
+        printf("%-28s %14.1f %14.1f %7.1fx\n", name.c_str(), legacy, current, legacy / current);
+    }
+
+    // Vinheta: multiplicação por uma máscara já pronta (o melhor caso sem o kernel).
+    Mat mask(frame.size(), CV_8UC3);
+    source.copyTo(frame);
+    mask.setTo(Scalar::all(255));
+    applyVignette(mask, 0.6);
+    legacy = timeMicros(iterations, [&](int) { multiply(frame, mask, frame, 1.0 / 255); });
+    current = timeMicros(iterations, [&](int) { applyVignette(frame, 0.6); });
+    printf("%-28s %14.1f %14.1f %7.1fx\n", "vinheta (mascara pronta)", legacy, current, legacy / current);
+
+    // Conferência: maior diferença de cada kernel para a conta de referência, em vários pesos.
+    auto maxDiff = [](const Mat& a, const Mat& b) { return (int)norm(a, b, NORM_INF); };
+    int scaleDiff = 0, blendDiff = 0, vignetteDiff = 0;
+    // Vinheta em double: wy(y) * wx(x), com as mesmas parábolas do applyVignette, em cada canal.
+    auto vignetteError = [&maxDiff](const Mat& image, double strength) {
+        double edge = sqrt(1 - strength);
+        auto axisWeight = [edge](int i, int size) {
+            double t = (2.0 * i - (size - 1)) / (size - 1);
+            return 1 - (1 - edge) * t * t;
+        };
+        Mat wx(1, image.cols, CV_64F), wy(image.rows, 1, CV_64F), weights, expected, got;
+        for (int x = 0; x < image.cols; x++)
+            wx.at<double>(x) = axisWeight(x, image.cols);
+        for (int y = 0; y < image.rows; y++)
+            wy.at<double>(y) = axisWeight(y, image.rows);
+        Mat plane = wy * wx;
+        vector<Mat> planes(image.channels(), plane);
+        merge(planes, weights);
+        image.convertTo(expected, CV_64F);
+        multiply(expected, weights, expected);
+        expected.convertTo(expected, image.type()); // Arredonda.
+        image.copyTo(got);
+        applyVignette(got, strength);
+        return maxDiff(expected, got);
+    };
+    Mat expected, got;
+    for (double factor : { 0.1, 0.3, 0.5, 0.7, 0.93 }) {
+        addWeighted(Mat::zeros(source.size(), source.type()), 1 - factor, source, factor, 0, expected);
+        source.copyTo(got);
+        scaleInPlace(got, factor);
+        scaleDiff = max(scaleDiff, maxDiff(expected, got));
+
+        Scalar color(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256));
+        addWeighted(Mat(source.size(), CV_8UC3, color), factor, source, 1 - factor, 0, expected); // Como o drawTransRect.
+        source.copyTo(got);
+        blendColorRect(got, Rect(0, 0, source.cols, source.rows), color, factor);
+        blendDiff = max(blendDiff, maxDiff(expected, got));
+
+        vignetteDiff = max(vignetteDiff, vignetteError(source, factor));
+    }
+    // Formas com a mesma largura em bytes (640x3 e 1920x1), uma depois da outra: a segunda não pode herdar os
+    // pesos por coluna da primeira.
+    Mat narrow = source(Rect(0, 0, 640, 360)), single;
+    extractChannel(source(Rect(0, 0, 1920, 360)), single, 0);
+    for (const Mat& image : { narrow, single, narrow })
+        vignetteDiff = max(vignetteDiff, vignetteError(image, 0.6));
+    printf("Maior diferenca da referencia: escurecer %d, retangulo %d, vinheta %d%s\n", scaleDiff, blendDiff, vignetteDiff,
+           scaleDiff > 1 || blendDiff > 1 || vignetteDiff > 2 ? "  (acima do limite de compositing.hpp!)" : "");
+}
+
+// Redesenho completo a cada frame contra o Compositor, em telas paradas e na partida.
+void benchCompositor() {
+    const int frames = 600; // 10 s de tela a 60 fps.
+    Mat camera[2]; // Quadros da câmera, alternados (a câmera manda um a cada 2 frames da tela).
+    RNG rng(11);
+    for (Mat& m : camera) {
+        m.create(720, 1280, CV_8UC3);
+        rng.fill(m, RNG::UNIFORM, 0, 256);
+    }
+    Mat rgba(100, 100, CV_8UC4);
+    rng.fill(rgba, RNG::UNIFORM, 0, 256);
+    Sprite target(rgba), nave(rgba(Rect(0, 0, 80, 80))), shot(rgba(Rect(0, 0, 20, 10)));
+    Ptr<freetype::FreeType2> ft2 = freetype::createFreeType2();
+    ft2->loadFontData("arcadeclassic.ttf", 0);
+    TextRenderer bigText(ft2, 80), menuText(ft2, 45), hudText(ft2, 30);
+    Scalar color(255, 255, 255);
+    const char* menu[] = { "CIs SPACE", "START", "CREDITS", "EXIT" };
+    TextLayer menuLayers[] = { TextLayer(bigText, color), TextLayer(menuText, color), TextLayer(menuText, color),
+                               TextLayer(menuText, color) };
+    TextLayer scoreText(hudText, color);
+    const int menuY[] = { -250, -70, 0, 70 };
+    for (int k = 0; k < 4; k++)
+        menuLayers[k].set(menu[k]);
+    const int frameBytes = 1280 * 720 * 3;
+
+    // Posições da partida no frame i: 10 alvos descendo, um tiro subindo e a nave.
+    auto targetAt = [](int i, int k) { return Point(100 + k * 110, (i * 4 + k * 70) % 800 - 100); };
+    auto shotAt = [](int i) { return Point(640, 700 - (i * 7) % 700); };
+    char score[32];
+    printf("%-24s %12s %12s %14s %14s\n", "tela (1280x720)", "cheio(us)", "camadas(us)", "cheio(KB/fr)", "camadas(KB/fr)");
+
+    for (int scenario = 0; scenario < 3; scenario++) {
+        Mat display;
+        double fullBytes = 0;
+        double full = timeMicros(frames, [&](int i) {
+            const Mat& background = scenario == 2 ? camera[(i / 2) % 2] : camera[0];
+            background.copyTo(display);
+            fullBytes += frameBytes;
+            if (scenario == 0) { // Menu: título e opções.
+                for (int k = 0; k < 4; k++) {
+                    TextRenderer& r = k == 0 ? bigText : menuText;
+                    Size size = r.glyphsSize(menu[k]);
+                    r.drawGlyphs(display, menu[k], Point(640 - size.width / 2, 360 + menuY[k]), color);
+                    fullBytes += size.area() * 3;
+                }
+            } else if (scenario == 1) { // Mensagem centralizada.
+                Size size = bigText.glyphsSize("FASE 2");
+                bigText.drawGlyphs(display, "FASE 2", Point((1280 - size.width) / 2, (720 + size.height) / 2), color);
+                fullBytes += size.area() * 3;
+            } else { // Partida sobre a câmera.
+                for (int k = 0; k < 10; k++)
+                    drawSprite(display, target, targetAt(i, k).x, targetAt(i, k).y);
+                drawSprite(display, shot, shotAt(i).x, shotAt(i).y);
+                drawSprite(display, nave, 600, 600);
+                snprintf(score, sizeof(score), "SCORE: %d", (i / 30) * 100);
+                hudText.drawGlyphs(display, score, Point(10, 40), color);
+                fullBytes += (10 * target.cols * target.rows + shot.cols * shot.rows + nave.cols * nave.rows) * 3;
+            }
+        });
+
+        Compositor scene;
+        double layeredBytes = 0;
+        double layered = timeMicros(frames, [&](int i) {
+            if (scenario == 2)
+                scene.setBackground(camera[(i / 2) % 2], i % 2 == 0); // Quadro novo a cada 2 frames.
+            else
+                scene.setBackground(camera[0], false);
+            if (scenario == 0) {
+                for (int k = 0; k < 4; k++) {
+                    Size size = menuLayers[k].textSize();
+                    scene.addText(menuLayers[k], Point(640 - size.width / 2, 360 + menuY[k]));
+                }
+            } else if (scenario == 1) {
+                menuLayers[0].set("FASE 2");
+                Size size = menuLayers[0].textSize();
+                scene.addText(menuLayers[0], Point((1280 - size.width) / 2, (720 + size.height) / 2));
+            } else {
+                for (int k = 0; k < 10; k++)
+                    scene.addSprite(target, targetAt(i, k));
+                scene.addSprite(shot, shotAt(i));
+                scene.addSprite(nave, Point(600, 600));
+                snprintf(score, sizeof(score), "SCORE: %d", (i / 30) * 100);
+                scoreText.set(score);
+                scene.addText(scoreText, Point(10, 40));
+            }
+            scene.compose();
+            layeredBytes += scene.bytesTouched();
+        });
+        const char* names[] = { "menu parado", "mensagem parada", "partida, camera 30 fps" };
+        printf("%-24s %12.1f %12.1f %14.0f %14.0f\n", names[scenario], full, layered, fullBytes / frames / 1024,
+               layeredBytes / frames / 1024);
+    }
+}
+
+// Direção que percorre um ciclo por todas as células (linhas em zigue-zague a partir da coluna 1, volta
+// pela coluna 0); com um número par de linhas a cobra anda nele para sempre sem bater.
+SnakeDirection snakeCycle(Point p, int cols, int rows) {
+    if (p.x == 0)
+        return p.y == 0 ? SnakeDirection::Right : SnakeDirection::Up;
+    if (p.y % 2 == 0)
+        return p.x < cols - 1 ? SnakeDirection::Right : SnakeDirection::Down;
+    if (p.x > 1 || p.y == rows - 1)
+        return SnakeDirection::Left;
+    return SnakeDirection::Down;
+}
+
+// Soak da cobrinha num tabuleiro de 1000x1000: custo de um passo (colisão pela grade, comida sorteada
+// entre as células livres) com cobras de 10 a 900 mil segmentos, contra a varredura da deque que a
+// colisão fazia antes. O passo deve ficar constante; a varredura cresce com o comprimento.
+// O desenho (células de 1 px) compara a atualização incremental do SnakeCanvas com o redesenho completo.
+void benchSnake() {
+    const int cols = 1000, rows = 1000;
+    const long lengths[] = { 10, 1000, 100000, 900000 };
+    const int steps = 200000;
+    SnakeBoard board(cols, rows, 42);
+    SnakeCanvas canvas(1);
+    printf("%-12s %12s %14s %16s %16s %10s\n", "segmentos", "passo(ns)", "desenho(ns)", "redesenho(us)", "varredura(ns)",
+           "comidas");
+    for (long length : lengths) {
+        board.reset(Point(0, 0));
+        board.grow((int)length - 1);
+        for (long i = 1; i < length; i++) // Cresce andando no ciclo.
+            board.step(snakeCycle(board.snake().front(), cols, rows));
+        size_t before = board.snake().size();
+        bool crashed = false;
+        double step = timeMicros(steps, [&](int) {
+            SnakeStep result = board.step(snakeCycle(board.snake().front(), cols, rows));
+            crashed |= result != SnakeStep::Moved && result != SnakeStep::Ate;
+        }) * 1000;
+        canvas.update(board, 0); // Redesenho completo; daqui em diante, uma atualização por passo.
+        double drawn = timeMicros(steps / 10, [&](int) {
+            board.step(snakeCycle(board.snake().front(), cols, rows));
+            canvas.update(board, (int)board.snake().size());
+        }) * 1000 - step;
+        double redrawn = timeMicros(max(3, (int)(20000000 / length)), [&](int) {
+            canvas.invalidate();
+            canvas.update(board, 0);
+        });
+        long eaten = (long)(board.snake().size() - before);
+        const deque<Point>& snake = board.snake();
+        Point next(-1, -1); // Fora da cobra: como num passo sem colisão, a varredura vai até o fim.
+        long found = 0;
+        double scan = timeMicros(max(10, (int)(200000000 / length)), [&](int) { // Colisão antiga: compara com cada segmento.
+            for (const Point& segment : snake)
+                found += segment == next;
+        }) * 1000;
+        printf("%-12zu %12.1f %14.1f %16.1f %16.1f %10ld%s\n", before, step, drawn, redrawn, scan, eaten,
+               crashed || found ? "  (bateu!)" : "");
+    }
+}
+
+// Memória residente do processo, em KB (0 fora do Linux).
+long residentKb() {
+#ifdef __linux__
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line))
+        if (line.compare(0, 6, "VmRSS:") == 0)
+            return atol(line.c_str() + 6);
+#endif
+    return 0;
+}
+
+// Carga do cascade de rosto em XML (FileStorage e montagem dos arrays) contra o .bin compilado
+// (mapeado e só validado): a primeira carga do processo, a média das seguintes e quanto a memória
+// residente cresce com o cascade carregado. O .bin sai do ./cascade_compile.
+void benchCascadeLoad() {
+    const string xml = "haarcascade_frontalface_default.xml", bin = HaarCascade::compiledPath(xml);
+    if (!ifstream(bin)) {
+        cout << "Rode ./cascade_compile " << xml << " antes (" << bin << " nao existe)" << endl;
+        return;
+    }
+    printf("%-8s %12s %12s %12s %10s\n", "formato", "primeira(ms)", "media(ms)", "residente(KB)", "bytes");
+    for (const string& path : { xml, bin }) {
+        HaarCascade first;
+        long before = residentKb();
+        int64 start = getTickCount();
+        bool loaded = first.load(path);
+        double firstMs = (getTickCount() - start) * 1000.0 / getTickFrequency();
+        long resident = residentKb() - before;
+        if (!loaded) {
+            cout << "Erro ao carregar " << path << endl;
+            continue;
+        }
+        double average = timeMicros(path == xml ? 20 : 2000, [&](int) {
+            HaarCascade again;
+            again.load(path);
+        }) / 1000;
+        printf("%-8s %12.3f %12.4f %12ld %10zu\n", path == xml ? "xml" : "bin", firstMs, average, resident, first.byteSize());
+    }
+}
+
+int main(int argc, char** argv) {
+    string mode = argc > 1 ? argv[1] : "all"; // Qual benchmark rodar.
+    string video = argc > 2 ? argv[2] : "video.mp4"; // Vídeo gravado usado pelos benchmarks de detecção.
+
+    if (mode == "sprite" || mode == "all")
+        benchSprite();
+    if (mode == "hud" || mode == "all")
+        benchHud();
+    if (mode == "tracker" || mode == "all")
+        benchTracker(video);
+    if (mode == "haar" || mode == "all")
+        benchHaar(video);
+    if (mode == "kernel" || mode == "all")
+        benchKernel(video);
+    if (mode == "detectscale" || mode == "all")
+        benchDetectScale(video);
+    if (mode == "collision" || mode == "all")
+        benchCollision();
+    if (mode == "mask" || mode == "all")
+        benchMask();
+    if (mode == "compositing" || mode == "all")
+        benchCompositing();
+    if (mode == "compositor" || mode == "all")
+        benchCompositor();
+    if (mode == "snake" || mode == "all")
+        benchSnake();
+    if (mode == "cascadeload" || mode == "all")
+        benchCascadeLoad();
+
+    return 0;
+}
@@ -0,0 +1,265 @@
+#pragma once
+
+#include <opencv2/core.hpp> // Mat e Size.
+#include <opencv2/imgproc.hpp> // cvtColor e resize.
+#include <opencv2/videoio.hpp> // VideoCapture.
+#include <algorithm> // std::max.
+#include <atomic> // Slots e contadores compartilhados com a thread da captura.
+#include <chrono> // Relógio das marcas de tempo e ritmo dos arquivos.
+#include <cstdint> // int64_t e uint64_t.
+#include <cstdlib> // setenv.
+#include <memory> // unique_ptr dos slots.
+#include <string> // Fonte da captura.
+#include <thread> // Thread da captura.
+#include <utility> // std::move.
+#include "frame_pool.hpp" // Buffers dos quadros reaproveitados.
+#include "profiler.hpp" // Tempo da leitura no trace.
+
+/**
+ * @brief Só o valor mais novo, entre uma thread que publica e uma que lê (triple buffer).
+ *
+ * São três buffers: um com quem escreve, um com quem lê e um no meio. Publicar e ler
+ * são uma troca atômica do índice do meio, sem trava e sem espera: quem escreve nunca
+ * bloqueia, e quem lê recebe sempre o último valor publicado. Um valor publicado por
+ * cima de outro que ninguém leu conta como descartado.
+ *
+ * @tparam T tipo armazenado; precisa ser construtível por padrão e movível.
+ */
+template <typename T>
+class LatestSlot {
+public:
+    LatestSlot(const LatestSlot&) = delete;
+    LatestSlot& operator=(const LatestSlot&) = delete;
+    LatestSlot() {}
+
+    /**
+     * @brief Publica value no lugar do valor anterior.
+     * @return true se o valor anterior não tinha sido lido (foi descartado).
+     */
+    bool publish(T value) {
+        buffers[writeIndex] = std::move(value);
+        int previous = middle.exchange(writeIndex | freshBit, std::memory_order_acq_rel);
+        writeIndex = previous & indexMask;
+        buffers[writeIndex] = T(); // Solta o valor antigo já (no caso de Mats, devolve o buffer ao pool).
+        bool dropped = (previous & freshBit) != 0;
+        if (dropped)
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return dropped;
+    }
+
+    /**
+     * @brief Pega o valor mais novo, se houver um que ainda não foi lido.
+     * @return false se nada novo foi publicado desde a última leitura.
+     */
+    bool take(T& out) {
+        if (!(middle.load(std::memory_order_relaxed) & freshBit))
+            return false;
+        int previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & indexMask;
+        out = std::move(buffers[readIndex]);
+        return true;
+    }
+
+    /** @brief Valores publicados por cima de outros não lidos. */
+    uint64_t dropped() const {
+        return droppedCount.load(std::memory_order_relaxed);
+    }
+
+private:
+    static const int indexMask = 3;
+    static const int freshBit = 4; // O buffer do meio tem um valor ainda não lido.
+
+    T buffers[3];
+    int writeIndex = 0; // Só quem escreve usa.
+    int readIndex = 1; // Só quem lê usa.
+    std::atomic<int> middle{ 2 };
+    std::atomic<uint64_t> droppedCount{ 0 };
+};
+
+/** @brief Quadro decodificado pela FrameCapture. */
+struct CapturedFrame {
+    cv::Mat frame; // Quadro colorido (BGR).
+    cv::Mat gray; // Versão em cinza, se pedida nas opções.
+    int64_t id = -1; // Número sequencial do quadro.
+    double time = 0; // Momento em que ficou pronto, em segundos do steady_clock.
+};
+
+/** @brief Opções da FrameCapture. */
+struct CaptureOptions {
+    cv::Size resolution; // Resolução pedida à fonte (vazia = a padrão); se ela mandar maior, o quadro é reduzido.
+    bool gray = false; // Converte também para cinza, na thread da captura.
+    bool loop = false; // Arquivos recomeçam no fim (substituto da câmera para testes).
+};
+
+/**
+ * @brief Captura de vídeo com latência baixa: decodifica na sua thread e guarda só o quadro mais novo.
+ *
+ * Quem consome (render, detecção) pega o último quadro pronto com take(); se ficar para
+ * trás, os quadros do meio são descartados em vez de enfileirados, e o que ele recebe
+ * tem no máximo um quadro de atraso. O buffer interno do decodificador também é
+ * reduzido (CAP_PROP_BUFFERSIZE e, no FFmpeg, as opções de RTSP sem buffer), para a
+ * latência não crescer do lado de lá.
+ *
+ * Fontes de arquivo andam no ritmo do seu FPS, como uma câmera; com loop recomeçam no
+ * fim, o que serve de câmera de teste.
+ *
+ *     FrameCapture capture(2); // Dois consumidores.
+ *     capture.open("rtsp://...", options);
+ *     capture.start();
+ *     CapturedFrame f;
+ *     if (capture.take(0, f)) ... // Quadro novo para o consumidor 0.
+ */
+class FrameCapture {
+public:
+    /**
+     * @param consumers número de consumidores; cada um tem o seu slot e recebe todo quadro novo.
+     */
+    explicit FrameCapture(size_t consumers = 1) : slotCount(consumers), slots(new LatestSlot<CapturedFrame>[consumers]) {}
+
+    ~FrameCapture() {
+        stop();
+    }
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    /**
+     * @param source URL (rtsp://, http://), arquivo de vídeo ou índice de câmera ("0").
+     */
+    bool open(const std::string& source, const CaptureOptions& captureOptions = CaptureOptions()) {
+        options = captureOptions;
+        stream = source.find("://") != std::string::npos;
+        bool device = !source.empty() && source.find_first_not_of("0123456789") == std::string::npos;
+#ifndef _WIN32
+        if (stream) // RTSP pelo FFmpeg sem buffer de reordenação; não muda o que o usuário já tenha definido.
+            setenv("OPENCV_FFMPEG_CAPTURE_OPTIONS", "fflags;nobuffer|flags;low_delay", 0);
+#endif
+        bool opened = device ? cap.open(std::stoi(source)) : cap.open(source);
+        if (!opened)
+            return false;
+        cap.set(cv::CAP_PROP_BUFFERSIZE, 1); // Nem todo backend aceita; os que aceitam seguram um quadro só.
+        if (!options.resolution.empty()) {
+            cap.set(cv::CAP_PROP_FRAME_WIDTH, options.resolution.width);
+            cap.set(cv::CAP_PROP_FRAME_HEIGHT, options.resolution.height);
+        }
+        file = !stream && !device;
+        double fps = cap.get(cv::CAP_PROP_FPS);
+        framePeriod = file ? 1.0 / (fps > 1 && fps < 240 ? fps : 30) : 0;
+        return true;
+    }
+
+    bool isOpened() const {
+        return cap.isOpened();
+    }
+
+    /** @brief Começa a decodificar na thread da captura. */
+    void start() {
+        if (worker.joinable())
+            return;
+        running = true;
+        worker = std::thread([this] { run(); });
+    }
+
+    /** @brief Para a thread (o último quadro de cada consumidor continua lá). */
+    void stop() {
+        running = false;
+        if (worker.joinable())
+            worker.join();
+    }
+
+    /**
+     * @brief Quadro mais novo que o consumidor ainda não recebeu, sem esperar.
+     * @return false se nenhum quadro novo chegou desde a última chamada.
+     */
+    bool take(size_t consumer, CapturedFrame& out) {
+        return slots[consumer].take(out);
+    }
+
+    /** @brief true depois que a fonte acabou ou deu erro (sem loop). */
+    bool failed() const {
+        return captureFailed;
+    }
+
+    /** @brief Quadros decodificados até agora. */
+    uint64_t captured() const {
+        return capturedCount;
+    }
+
+    /** @brief Quadros que o consumidor perdeu por não pegar a tempo. */
+    uint64_t dropped(size_t consumer) const {
+        return slots[consumer].dropped();
+    }
+
+    /** @brief Segundos do steady_clock, a base de CapturedFrame::time. */
+    static double now() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+private:
+    void run() {
+        PROFILE_THREAD("captura");
+        // Os consumidores seguram cada quadro por um tempo; os buffers voltam para o pool quando todos o soltam.
+        FramePool decodePool(12), scaledPool(12), grayPool(12);
+        cv::Mat decoded;
+        cv::Size decodedSize; // Tamanho do último quadro (os próximos costumam ter o mesmo).
+        double nextFrame = now();
+        while (running) {
+            if (framePeriod > 0) { // Arquivo: espera a hora do quadro, como uma câmera.
+                double wait = nextFrame - now();
+                if (wait > 0)
+                    std::this_thread::sleep_for(std::chrono::duration<double>(wait));
+                nextFrame = std::max(nextFrame + framePeriod, now() - framePeriod);
+            }
+            decoded.release();
+            if (!decodedSize.empty())
+                decoded = decodePool.acquire(decodedSize, CV_8UC3); // Buffer reaproveitado; a leitura escreve nele.
+            if (!read(decoded)) {
+                captureFailed = true;
+                break;
+            }
+            decodedSize = decoded.size();
+
+            CapturedFrame packet;
+            packet.time = now();
+            packet.id = (int64_t)capturedCount;
+            const cv::Size& wanted = options.resolution;
+            if (!wanted.empty() && (decoded.cols > wanted.width || decoded.rows > wanted.height)) {
+                PROFILE_SCOPE("reducao"); // A fonte ignorou a resolução pedida.
+                packet.frame = scaledPool.acquire(wanted, CV_8UC3);
+                cv::resize(decoded, packet.frame, wanted, 0, 0, cv::INTER_AREA);
+            } else {
+                packet.frame = decoded;
+            }
+            if (options.gray) {
+                PROFILE_SCOPE("cvtColor");
+                packet.gray = grayPool.acquire(packet.frame.size(), CV_8UC1);
+                cv::cvtColor(packet.frame, packet.gray, cv::COLOR_BGR2GRAY);
+            }
+            capturedCount++;
+            for (size_t i = 0; i < slotCount; i++)
+                slots[i].publish(packet); // Cópia só do cabeçalho; os Mats são compartilhados.
+        }
+    }
+
+    // Lê o próximo quadro; no fim de um arquivo com loop, volta ao começo.
+    bool read(cv::Mat& frame) {
+        PROFILE_SCOPE("captura");
+        if (cap.read(frame) && !frame.empty())
+            return true;
+        if (!options.loop || !file || !cap.set(cv::CAP_PROP_POS_FRAMES, 0))
+            return false;
+        return cap.read(frame) && !frame.empty();
+    }
+
+    cv::VideoCapture cap;
+    CaptureOptions options;
+    bool stream = false; // URL de rede.
+    bool file = false; // Arquivo de vídeo (nem rede nem câmera).
+    double framePeriod = 0; // Intervalo entre quadros de um arquivo (0 = no ritmo da fonte).
+    size_t slotCount;
+    std::unique_ptr<LatestSlot<CapturedFrame>[]> slots; // Um por consumidor.
+    std::thread worker;
+    std::atomic<bool> running{ false };
+    std::atomic<bool> captureFailed{ false };
+    std::atomic<uint64_t> capturedCount{ 0 };
+};
@@ -0,0 +1,52 @@
+#include <opencv2/core.hpp> // getTickCount.
+#include <iostream> // Inclui a biblioteca de entrada/saída padrão do C++.
+#include <string> // Inclui a classe string.
+#include <cstdio> // printf do resumo.
+#include "haar_detector.hpp" // HaarCascade: leitura do XML e formato compilado.
+
+using namespace cv;
+using namespace std;
+
+// Compila cascades Haar em XML para o formato binário do HaarCascade (.bin): arrays alinhados,
+// prontos para mapear, sem nada para interpretar na carga.
+//
+//   ./cascade_compile haarcascade_frontalface_default.xml [hand.xml ...]
+//
+// Cada .bin é gravado ao lado do XML, com o mesmo nome; os programas que usam loadPreferCompiled
+// passam a carregá-lo enquanto ele não for mais velho que o XML.
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        cout << "Uso: " << argv[0] << " cascade.xml [outro.xml ...]" << endl;
+        return -1;
+    }
+    int failures = 0;
+    for (int i = 1; i < argc; i++) {
+        string xmlPath = argv[i], binPath = HaarCascade::compiledPath(xmlPath);
+        HaarCascade fromXml, fromBin;
+        int64 start = getTickCount();
+        bool loaded = fromXml.load(xmlPath);
+        double xmlMs = (getTickCount() - start) * 1000.0 / getTickFrequency();
+        if (!loaded) {
+            cout << "Erro ao ler " << xmlPath << endl;
+            failures++;
+            continue;
+        }
+        if (!fromXml.save(binPath)) {
+            cout << "Erro ao gravar " << binPath << endl;
+            failures++;
+            continue;
+        }
+        start = getTickCount();
+        loaded = fromBin.load(binPath);
+        double binMs = (getTickCount() - start) * 1000.0 / getTickFrequency();
+        if (!loaded || !fromBin.sameData(fromXml)) { // Confere a volta: o .bin tem que dar o mesmo cascade.
+            cout << "O arquivo gravado nao confere com o XML: " << binPath << endl;
+            failures++;
+            continue;
+        }
+        printf("%s -> %s: %zu estagios, %d classificadores fracos, %zu bytes; carga %.2f ms (XML) / %.3f ms (.bin)\n",
+               xmlPath.c_str(), binPath.c_str(), fromXml.stageThreshold.size(), fromXml.weakCount(), fromXml.byteSize(), xmlMs,
+               binMs);
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm> // std::max.
+#include <cmath> // std::floor.
+#include <cstdint> // uint32_t.
+#include <vector> // Entradas e baldes da grade.
+#include "entity_store.hpp" // Entidades indexadas.
+
+/** @brief Narrow phase: true se os retângulos (x, y, largura, altura) se sobrepõem. */
+inline bool rectsOverlap(float ax, float ay, float aw, float ah, float bx, float by, float bw, float bh) {
+    return ax < bx + bw && bx < ax + aw && ay < by + bh && by < ay + ah;
+}
+
+/**
+ * @brief Broad phase de colisão: grade uniforme guardada numa tabela hash de células.
+ *
+ * build() coloca cada entidade de um tipo na célula do seu canto superior esquerdo
+ * (uma célula só, sem duplicatas). Com células pelo menos do tamanho do maior
+ * sprite, query() só precisa olhar as células que vão de maxWidth/maxHeight antes
+ * do retângulo até o fim dele, e devolve candidatos que o narrow phase
+ * (rectsOverlap ou a máscara dos sprites) confirma.
+ *
+ * A tabela é remontada a cada tick com uma ordenação por contagem (O(n)) em vetores
+ * reaproveitados, então depois do primeiro tick não há alocação. As células são
+ * hash de (cx, cy), e a grade não precisa de limites: alvos acima da tela entram
+ * normalmente.
+ */
+class CollisionGrid {
+public:
+    /**
+     * @param cellSize lado da célula em pixels; use o maior lado dos sprites indexados.
+     */
+    explicit CollisionGrid(float cellSize = 128) : cellSize(cellSize) {}
+
+    void setCellSize(float size) {
+        cellSize = size;
+    }
+
+    float getCellSize() const {
+        return cellSize;
+    }
+
+    /**
+     * @brief Indexa as entidades vivas do tipo dado.
+     * @param maxWidth, maxHeight maior tamanho dessas entidades (o do sprite delas).
+     */
+    void build(const EntityStore& e, EntityType t, float maxWidth, float maxHeight) {
+        extentX = maxWidth;
+        extentY = maxHeight;
+        entries.clear();
+        for (size_t i = 0; i < e.size(); i++) {
+            if (e.type[i] != t || !e.alive[i])
+                continue;
+            entries.push_back(Entry{ (uint32_t)i, cellOf(e.x[i]), cellOf(e.y[i]) });
+        }
+        size_t buckets = 16;
+        while (buckets < entries.size() * 2) // Tabela com no máximo meia ocupação.
+            buckets <<= 1;
+        mask = (uint32_t)(buckets - 1);
+        bucketStart.assign(buckets + 1, 0);
+        for (const Entry& entry : entries)
+            bucketStart[bucketOf(entry.cx, entry.cy) + 1]++;
+        for (size_t b = 0; b < buckets; b++)
+            bucketStart[b + 1] += bucketStart[b];
+        sorted.resize(entries.size());
+        cursor.assign(bucketStart.begin(), bucketStart.end() - 1);
+        for (const Entry& entry : entries)
+            sorted[cursor[bucketOf(entry.cx, entry.cy)]++] = entry;
+    }
+
+    /**
+     * @brief Chama visit(i) para cada entidade indexada que pode tocar o retângulo
+     * (índice denso do EntityStore). Se visit devolver false a busca para.
+     */
+    template <typename F>
+    void query(float x, float y, float w, float h, F&& visit) const {
+        if (sorted.empty())
+            return;
+        int cx0 = cellOf(x - extentX), cx1 = cellOf(x + w);
+        int cy0 = cellOf(y - extentY), cy1 = cellOf(y + h);
+        for (int cy = cy0; cy <= cy1; cy++) {
+            for (int cx = cx0; cx <= cx1; cx++) {
+                uint32_t b = bucketOf(cx, cy);
+                for (uint32_t k = bucketStart[b]; k < bucketStart[b + 1]; k++) {
+                    const Entry& entry = sorted[k];
+                    if (entry.cx == cx && entry.cy == cy && !visit((size_t)entry.index)) // Outra célula no mesmo balde: ignora.
+                        return;
+                }
+            }
+        }
+    }
+
+    /** @brief Número de entidades indexadas no último build(). */
+    size_t size() const {
+        return sorted.size();
+    }
+
+private:
+    struct Entry {
+        uint32_t index; // Índice denso no EntityStore.
+        int cx, cy; // Célula do canto superior esquerdo.
+    };
+
+    int cellOf(float v) const {
+        return (int)std::floor(v / cellSize);
+    }
+
+    uint32_t bucketOf(int cx, int cy) const {
+        return ((uint32_t)cx * 73856093u ^ (uint32_t)cy * 19349663u) & mask;
+    }
+
+    float cellSize;
+    float extentX = 0, extentY = 0; // Maior sprite indexado.
+    uint32_t mask = 0; // Número de baldes - 1 (potência de 2).
+    std::vector<Entry> entries; // Entidades na ordem do EntityStore.
+    std::vector<Entry> sorted; // Entidades agrupadas por balde.
+    std::vector<uint32_t> bucketStart; // Início de cada balde em sorted (+1 no fim).
+    std::vector<uint32_t> cursor; // Posição de escrita de cada balde durante o build.
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <algorithm> // std::max, std::min.
+#include <cstdint> // uint64_t.
+#include <vector> // Bits das linhas.
+#include "sprite.hpp" // Canal alfa dos sprites.
+
+/**
+ * @brief Máscara de colisão de um sprite: um bit por pixel, ligado onde o sprite é visível.
+ *
+ * Montada uma vez na carga a partir do canal alfa (alfa >= threshold). Cada linha
+ * ocupa words palavras de 64 bits (bit k da linha = bit k % 64 da palavra k / 64),
+ * de modo que testar a sobreposição de duas máscaras é um AND deslocado por linha,
+ * 64 pixels de cada vez, em vez de comparar Mats pixel a pixel.
+ */
+struct CollisionMask {
+    int cols = 0; // Largura em pixels.
+    int rows = 0; // Altura em pixels.
+    int words = 0; // Palavras de 64 bits por linha.
+    std::vector<uint64_t> bits; // rows * words palavras.
+
+    CollisionMask() {}
+
+    /**
+     * @param sprite sprite carregado; se for opaco, a máscara é o retângulo inteiro.
+     * @param threshold menor alfa considerado sólido.
+     */
+    explicit CollisionMask(const Sprite& sprite, int threshold = 128) {
+        cols = sprite.cols;
+        rows = sprite.rows;
+        words = (cols + 63) / 64;
+        bits.assign((size_t)rows * words, 0);
+        for (int y = 0; y < rows; y++) {
+            uint64_t* row = bits.data() + (size_t)y * words;
+            const uchar* alpha = sprite.opaque() ? nullptr : sprite.alpha.ptr<uchar>(y);
+            for (int x = 0; x < cols; x++)
+                if (!alpha || alpha[x] >= threshold)
+                    row[x >> 6] |= 1ull << (x & 63);
+        }
+    }
+
+    bool empty() const {
+        return bits.empty();
+    }
+
+    const uint64_t* row(int y) const {
+        return bits.data() + (size_t)y * words;
+    }
+
+    /** @brief 64 bits da linha a partir do bit start (que pode ser negativo); fora da linha vem 0. */
+    static uint64_t extract(const uint64_t* row, int words, int start) {
+        int word = start >= 0 ? start >> 6 : -((63 - start) >> 6); // Divisão arredondando para baixo.
+        int shift = start - word * 64;
+        uint64_t lo = word >= 0 && word < words ? row[word] : 0;
+        if (shift == 0)
+            return lo;
+        uint64_t hi = word + 1 >= 0 && word + 1 < words ? row[word + 1] : 0;
+        return (lo >> shift) | (hi << (64 - shift));
+    }
+};
+
+/**
+ * @brief true se as máscaras, com os cantos superiores esquerdos em (ax, ay) e (bx, by),
+ * têm algum pixel sólido em comum. Retângulos disjuntos saem antes de olhar os bits.
+ */
+inline bool masksOverlap(const CollisionMask& a, int ax, int ay, const CollisionMask& b, int bx, int by) {
+    int x0 = std::max(ax, bx), x1 = std::min(ax + a.cols, bx + b.cols);
+    int y0 = std::max(ay, by), y1 = std::min(ay + a.rows, by + b.rows);
+    if (x0 >= x1 || y0 >= y1)
+        return false;
+    int first = x0 - ax, last = x1 - ax; // Colunas de a que se sobrepõem a b: [first, last).
+    for (int y = y0; y < y1; y++) {
+        const uint64_t* rowA = a.row(y - ay);
+        const uint64_t* rowB = b.row(y - by);
+        for (int w = first >> 6; w <= (last - 1) >> 6; w++) {
+            uint64_t keep = ~0ull; // Só as colunas dentro da sobreposição.
+            if (w == first >> 6)
+                keep &= ~0ull << (first & 63);
+            if (w == (last - 1) >> 6 && (last & 63))
+                keep &= ~0ull >> (64 - (last & 63));
+            if (rowA[w] & keep & CollisionMask::extract(rowB, b.words, w * 64 + ax - bx))
+                return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <opencv2/core.hpp> // Mat, Rect e Scalar.
+#include <algorithm> // std::min, std::max.
+#include <climits> // INT_MAX.
+#include <cmath> // std::lround.
+#include <cstdint> // uint16_t.
+#include <vector> // Pesos por coluna da vinheta.
+
+#if defined(__SSE2__)
+#include <emmintrin.h> // Intrínsecos SSE2.
+#endif
+
+/**
+ * Efeitos de tela feitos no próprio quadro, numa passada só e sem Mats temporários.
+ *
+ * Todos usam a mesma conta em ponto fixo com pesos de 0 a 256, byte a byte:
+ * dst = (dst * peso + cor * (256 - peso) + 128) / 256. Escurecer e misturar uma cor
+ * ficam a no máximo 1 de diferença do addWeighted equivalente; a vinheta, que arredonda
+ * dois pesos (coluna e linha), fica a no máximo 2 da conta em double.
+ * ./benchmark compositing confere esses limites.
+ */
+
+/** @brief dst = (dst * mul + add + 128) >> 8 para n bytes, com mul <= 256 e add <= (256 - mul) * 255. */
+inline void mulAddRow(uchar* dst, int n, uint16_t mul, uint16_t add) {
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i m = _mm_set1_epi16((short)mul);
+    const __m128i a = _mm_set1_epi16((short)(add + 128));
+    for (; i + 16 <= n; i += 16) {
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i lo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), m), a), 8);
+        __m128i hi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), m), a), 8);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; i < n; i++)
+        dst[i] = (uchar)((dst[i] * mul + add + 128) >> 8);
+}
+
+/**
+ * @brief Como mulAddRow, mas com add diferente para cada canal de um pixel BGR: add3[i % 3].
+ * n precisa ser múltiplo de 3 e dst começar no primeiro canal de um pixel.
+ */
+inline void mulAddRowBGR(uchar* dst, int n, uint16_t mul, const uint16_t add3[3]) {
+    int i = 0;
+#if defined(__SSE2__)
+    // O padrão B,G,R se repete a cada 48 bytes (3 vetores de 16); cada vetor tem a sua fase.
+    alignas(16) uint16_t pattern[48];
+    for (int k = 0; k < 48; k++)
+        pattern[k] = (uint16_t)(add3[k % 3] + 128);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i m = _mm_set1_epi16((short)mul);
+    __m128i p[6];
+    for (int k = 0; k < 6; k++)
+        p[k] = _mm_load_si128((const __m128i*)(pattern + k * 8));
+    for (; i + 48 <= n; i += 48) {
+        for (int v = 0; v < 3; v++) {
+            __m128i d = _mm_loadu_si128((const __m128i*)(dst + i + v * 16));
+            __m128i lo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), m), p[v * 2]), 8);
+            __m128i hi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), m), p[v * 2 + 1]), 8);
+            _mm_storeu_si128((__m128i*)(dst + i + v * 16), _mm_packus_epi16(lo, hi));
+        }
+    }
+#endif
+    for (; i < n; i++)
+        dst[i] = (uchar)((dst[i] * mul + add3[i % 3] + 128) >> 8);
+}
+
+/**
+ * @brief dst[i] = (dst[i] * w + 128) >> 8 com w = weights[i] * rowWeight / 256, para n bytes.
+ * weights vêm multiplicados por 16 (pesos de 0 a 256 viram 0 a 4096), para o produto caber em 16 bits.
+ */
+inline void mulRowWeights(uchar* dst, int n, const uint16_t* weights, uint16_t rowWeight) {
+    int i = 0;
+    uint16_t row16 = (uint16_t)(rowWeight << 4);
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi16(128);
+    const __m128i r = _mm_set1_epi16((short)row16);
+    for (; i + 16 <= n; i += 16) {
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i w0 = _mm_mulhi_epu16(_mm_loadu_si128((const __m128i*)(weights + i)), r); // Peso final, 0 a 256.
+        __m128i w1 = _mm_mulhi_epu16(_mm_loadu_si128((const __m128i*)(weights + i + 8)), r);
+        __m128i lo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), w0), half), 8);
+        __m128i hi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), w1), half), 8);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; i < n; i++) {
+        int w = (weights[i] * row16) >> 16;
+        dst[i] = (uchar)((dst[i] * w + 128) >> 8);
+    }
+}
+
+/** @brief Peso em ponto fixo (0 a 256) de um fator entre 0 e 1. */
+inline uint16_t fixedWeight(double factor) {
+    return (uint16_t)std::lround(std::min(std::max(factor, 0.0), 1.0) * 256);
+}
+
+/**
+ * @brief Multiplica os pixels de region (o quadro inteiro por padrão) por factor (0 a 1).
+ * Substitui o Mat::zeros + addWeighted usado para escurecer a tela por trás das mensagens.
+ */
+inline void scaleInPlace(cv::Mat& frame, double factor, cv::Rect region = cv::Rect(0, 0, INT_MAX, INT_MAX)) {
+    CV_Assert(frame.depth() == CV_8U);
+    region &= cv::Rect(0, 0, frame.cols, frame.rows);
+    uint16_t mul = fixedWeight(factor);
+    int bytes = region.width * frame.channels();
+    for (int y = region.y; y < region.y + region.height; y++)
+        mulAddRow(frame.ptr<uchar>(y) + region.x * frame.channels(), bytes, mul, 0);
+}
+
+/**
+ * @brief Mistura uma cor sólida sobre region: dst = cor * alpha + dst * (1 - alpha).
+ * Mesmo resultado do drawTransRect (addWeighted com um Mat da cor), sem criar esse Mat.
+ */
+inline void blendColorRect(cv::Mat& frame, cv::Rect region, const cv::Scalar& color, double alpha) {
+    CV_Assert(frame.type() == CV_8UC3);
+    region &= cv::Rect(0, 0, frame.cols, frame.rows);
+    uint16_t weight = fixedWeight(alpha); // Peso da cor.
+    uint16_t add3[3];
+    for (int k = 0; k < 3; k++)
+        add3[k] = (uint16_t)(cv::saturate_cast<uchar>(color[k]) * weight);
+    for (int y = region.y; y < region.y + region.height; y++)
+        mulAddRowBGR(frame.ptr<uchar>(y) + region.x * 3, region.width * 3, (uint16_t)(256 - weight), add3);
+}
+
+/**
+ * @brief Escurece as bordas do quadro: o centro fica igual e os cantos são multiplicados
+ * por (1 - strength). O peso é separável, wx(x) * wy(y), com wx e wy parábolas que vão
+ * de 1 no centro a sqrt(1 - strength) na borda.
+ *
+ * Cada pixel é lido e escrito uma vez; os pesos por coluna ficam guardados entre as
+ * chamadas (por thread), então em regime não há alocação.
+ */
+inline void applyVignette(cv::Mat& frame, double strength) {
+    CV_Assert(frame.depth() == CV_8U);
+    int channels = frame.channels();
+    int bytes = frame.cols * channels;
+    double edge = std::sqrt(1 - std::min(std::max(strength, 0.0), 1.0)); // Peso de cada eixo na borda.
+    auto axisWeight = [edge](int i, int size) {
+        double t = size > 1 ? (2.0 * i - (size - 1)) / (size - 1) : 0; // -1 a 1.
+        return 1 - (1 - edge) * t * t;
+    };
+
+    thread_local std::vector<uint16_t> columnWeights; // wx(x) * 16, repetido por canal.
+    thread_local double cachedEdge = -1;
+    thread_local int cachedCols = -1, cachedChannels = -1; // A largura em bytes não basta: 640x3 e 1920x1 dão 1920.
+    if (cachedEdge != edge || cachedCols != frame.cols || cachedChannels != channels) {
+        columnWeights.resize(bytes);
+        for (int x = 0; x < frame.cols; x++)
+            for (int k = 0; k < channels; k++)
+                columnWeights[x * channels + k] = (uint16_t)(std::lround(axisWeight(x, frame.cols) * 256) << 4);
+        cachedEdge = edge;
+        cachedCols = frame.cols;
+        cachedChannels = channels;
+    }
+    for (int y = 0; y < frame.rows; y++) {
+        uint16_t wy = (uint16_t)std::lround(axisWeight(y, frame.rows) * 256);
+        mulRowWeights(frame.ptr<uchar>(y), bytes, columnWeights.data(), wy);
+    }
+}
@@ -0,0 +1,307 @@
+#pragma once
+
+#include <opencv2/core.hpp> // Mat, Rect e Scalar.
+#include <opencv2/imgproc.hpp> // rectangle.
+#include <algorithm> // std::min, std::max.
+#include <cstdint> // uint64_t.
+#include <cstring> // strcmp, strncpy.
+#include <vector> // Itens e retângulos sujos.
+#include "profiler.hpp" // Tempo do fundo, dos sprites e do texto dentro do compose().
+#include "sprite.hpp" // Sprites e drawSprite.
+#include "text_renderer.hpp" // Glifos do texto das camadas.
+
+/**
+ * @brief Texto pré-renderizado como sprite, refeito só quando o texto muda.
+ *
+ * O texto é desenhado uma vez sobre preto em dois planos: com a cor dele, o que já dá a
+ * cor pré-multiplicada pelo alfa, e em branco, que dá o alfa. Com os dois vira um Sprite
+ * comum, e desenhar o HUD num frame é um drawSprite do tamanho do texto.
+ *
+ * Os buffers só crescem; com reserve() do maior texto esperado, trocar o texto (a
+ * pontuação subindo) não aloca.
+ */
+class TextLayer {
+public:
+    TextLayer(TextRenderer& renderer, const cv::Scalar& color) : renderer(&renderer), color(color) {
+        current[0] = '\0';
+    }
+
+    /** @brief Garante buffers do tamanho de sample (o maior texto esperado). */
+    void reserve(const char* sample) {
+        cv::Rect bounds = renderer->glyphsBounds(sample);
+        grow(bounds.size());
+    }
+
+    /**
+     * @brief Troca o texto; só re-renderiza se for diferente do atual.
+     * @return true se o sprite mudou.
+     */
+    bool set(const char* text) {
+        if (rendered && std::strcmp(text, current) == 0)
+            return false;
+        std::strncpy(current, text, sizeof(current) - 1);
+        current[sizeof(current) - 1] = '\0';
+        bounds = renderer->glyphsBounds(current);
+        size = renderer->glyphsSize(current);
+        rendered = true;
+        if (bounds.empty()) {
+            layer = Sprite();
+            revisionCount++;
+            return true;
+        }
+        grow(bounds.size());
+        cv::Rect area(0, 0, bounds.width, bounds.height);
+        cv::Mat colorPlane = colorBuffer(area), alphaPlane = alphaBuffer(area);
+        colorPlane.setTo(cv::Scalar::all(0));
+        alphaPlane.setTo(cv::Scalar::all(0));
+        cv::Point org(-bounds.x, -bounds.y); // Origem que põe a tinta no canto do buffer.
+        renderer->drawGlyphs(colorPlane, current, org, color); // Sobre preto: cor * alfa.
+        renderer->drawGlyphs(alphaPlane, current, org, cv::Scalar::all(255)); // Branco sobre preto: alfa.
+        cv::subtract(cv::Scalar::all(255), alphaPlane, alphaPlane); // Vira 255 - alfa, como em Sprite::invAlpha.
+        layer.color = colorPlane;
+        layer.invAlpha = alphaPlane;
+        layer.cols = bounds.width;
+        layer.rows = bounds.height;
+        revisionCount++;
+        return true;
+    }
+
+    const Sprite& sprite() const {
+        return layer;
+    }
+
+    /** @brief Canto superior esquerdo do sprite para o texto ter a origem (linha de base) em org. */
+    cv::Point topLeft(cv::Point org) const {
+        return org + bounds.tl();
+    }
+
+    /** @brief Muda a cada re-renderização; o Compositor usa para saber que o conteúdo mudou. */
+    uint64_t revision() const {
+        return revisionCount;
+    }
+
+    /** @brief Tamanho do texto, como TextRenderer::glyphsSize. */
+    cv::Size textSize() const {
+        return size;
+    }
+
+private:
+    void grow(cv::Size needed) {
+        if (needed.width <= colorBuffer.cols && needed.height <= colorBuffer.rows)
+            return;
+        cv::Size grown(std::max(needed.width, colorBuffer.cols), std::max(needed.height, colorBuffer.rows));
+        colorBuffer.create(grown, CV_8UC3);
+        alphaBuffer.create(grown, CV_8UC3);
+    }
+
+    TextRenderer* renderer;
+    cv::Scalar color;
+    char current[64]; // Texto renderizado agora.
+    bool rendered = false;
+    cv::Rect bounds; // Caixa da tinta em relação à origem.
+    cv::Size size;
+    cv::Mat colorBuffer, alphaBuffer; // Buffers reaproveitados; o sprite usa um recorte deles.
+    Sprite layer;
+    uint64_t revisionCount = 0;
+};
+
+/**
+ * @brief Monta a tela em camadas (fundo, mundo, HUD) redesenhando só o que mudou.
+ *
+ * A cada frame o chamador informa o fundo (e se o conteúdo dele é novo) e a lista de
+ * sprites e retângulos de cada camada. compose() compara com a lista do frame anterior:
+ * o que apareceu, sumiu, mudou de lugar ou foi invalidado vira um retângulo sujo, e só
+ * esses retângulos são refeitos (fundo copiado e os itens que os tocam desenhados por
+ * cima, recortados). Um fundo novo, como o quadro da câmera, suja a tela inteira.
+ *
+ * As regiões sujas são disjuntas, então cada etapa passa por todas antes da próxima:
+ * o fundo, depois a camada World ("sprites" no profiler) e por fim a Hud ("texto").
+ *
+ * Em telas paradas (menu, mensagens) um frame sem mudanças não toca nenhum pixel.
+ * bytesTouched() informa quantos bytes o último compose() escreveu.
+ */
+class Compositor {
+public:
+    enum Layer { World = 0, Hud = 1 }; // Ordem de desenho, depois do fundo.
+
+    /**
+     * @param background imagem BGR do fundo; precisa continuar válida até o compose().
+     * @param changed true se o conteúdo do fundo mudou desde o último frame.
+     */
+    void setBackground(const cv::Mat& image, bool changed) {
+        CV_Assert(image.type() == CV_8UC3);
+        if (changed || image.data != background.data || image.size() != background.size())
+            fullRedraw = true;
+        background = image;
+    }
+
+    void addSprite(const Sprite& sprite, cv::Point topLeft, Layer layer = World) {
+        if (sprite.empty())
+            return;
+        Item item;
+        item.sprite = &sprite;
+        item.rect = cv::Rect(topLeft, sprite.size());
+        item.layer = layer;
+        items.push_back(item);
+    }
+
+    /** @brief Texto com a origem (linha de base) em org; é refeito quando o texto da camada muda. */
+    void addText(const TextLayer& text, cv::Point org, Layer layer = Hud) {
+        if (text.sprite().empty())
+            return;
+        addSprite(text.sprite(), text.topLeft(org), layer);
+        items.back().revision = text.revision();
+    }
+
+    void addRectangle(const cv::Rect& rect, const cv::Scalar& color, int thickness, Layer layer = World) {
+        Item item;
+        item.rect = rect;
+        item.color = color;
+        item.thickness = thickness;
+        item.layer = layer;
+        items.push_back(item);
+    }
+
+    /** @brief Marca uma região para ser refeita (conteúdo de um sprite mudou, algo foi desenhado por fora). */
+    void invalidate(const cv::Rect& rect) {
+        dirty.push_back(rect);
+    }
+
+    void invalidateAll() {
+        fullRedraw = true;
+    }
+
+    /** @brief Refaz as regiões sujas e devolve a tela; os itens adicionados valem só para este frame. */
+    cv::Mat& compose() {
+        cv::Rect screen(0, 0, background.cols, background.rows);
+        if (output.size() != background.size()) {
+            output.create(background.size(), CV_8UC3);
+            fullRedraw = true;
+        }
+        if (!fullRedraw)
+            diffItems();
+        else {
+            dirty.clear();
+            dirty.push_back(screen);
+        }
+        mergeDirty(screen);
+
+        touched = 0;
+        {
+            PROFILE_SCOPE("fundo");
+            for (const cv::Rect& region : dirty) {
+                background(region).copyTo(output(region));
+                touched += (uint64_t)region.area() * 3;
+            }
+        }
+        {
+            PROFILE_SCOPE("sprites");
+            drawLayer(World);
+        }
+        {
+            PROFILE_SCOPE("texto");
+            drawLayer(Hud);
+        }
+        dirty.clear();
+        previous.swap(items);
+        items.clear();
+        fullRedraw = false;
+        return output;
+    }
+
+    /** @brief Bytes escritos pelo último compose() (fundo copiado mais itens desenhados). */
+    uint64_t bytesTouched() const {
+        return touched;
+    }
+
+private:
+    struct Item {
+        const Sprite* sprite = nullptr; // Sprite, ou nullptr para um retângulo.
+        cv::Rect rect; // Posição e tamanho.
+        cv::Scalar color; // Cor do retângulo.
+        int thickness = 1; // Espessura do retângulo.
+        int layer = World;
+        uint64_t revision = 0; // Versão do conteúdo do sprite (TextLayer::revision).
+    };
+
+    // Desenha os itens da camada nas regiões sujas, recortados por elas.
+    void drawLayer(int layer) {
+        for (const cv::Rect& region : dirty) {
+            cv::Mat target = output(region);
+            for (const Item& item : items) {
+                if (item.layer != layer)
+                    continue;
+                cv::Rect overlap = bounds(item) & region;
+                if (overlap.empty())
+                    continue;
+                touched += (uint64_t)overlap.area() * 3;
+                if (item.sprite) // Recortado pela região: drawSprite corta o que sai do alvo.
+                    drawSprite(target, *item.sprite, item.rect.x - region.x, item.rect.y - region.y);
+                else
+                    cv::rectangle(target, item.rect - region.tl(), item.color, item.thickness);
+            }
+        }
+    }
+
+    // Região que o item pode alterar (o contorno do retângulo passa um pouco da borda).
+    static cv::Rect bounds(const Item& item) {
+        if (item.sprite)
+            return item.rect;
+        int pad = item.thickness / 2 + 1;
+        return cv::Rect(item.rect.x - pad, item.rect.y - pad, item.rect.width + 2 * pad, item.rect.height + 2 * pad);
+    }
+
+    static bool same(const Item& a, const Item& b) {
+        return a.sprite == b.sprite && a.rect == b.rect && a.layer == b.layer && a.revision == b.revision && a.thickness == b.thickness
+            && a.color == b.color;
+    }
+
+    // Suja as regiões dos itens que mudaram em relação ao frame anterior (na mesma posição da lista).
+    void diffItems() {
+        size_t common = std::min(items.size(), previous.size());
+        for (size_t i = 0; i < common; i++) {
+            if (same(items[i], previous[i]))
+                continue;
+            dirty.push_back(bounds(previous[i]));
+            dirty.push_back(bounds(items[i]));
+        }
+        for (size_t i = common; i < previous.size(); i++) // Sumiram.
+            dirty.push_back(bounds(previous[i]));
+        for (size_t i = common; i < items.size(); i++) // Apareceram.
+            dirty.push_back(bounds(items[i]));
+    }
+
+    // Recorta pela tela e junta retângulos que se tocam, para nada ser refeito duas vezes.
+    void mergeDirty(const cv::Rect& screen) {
+        for (cv::Rect& r : dirty)
+            r &= screen;
+        bool merged = true;
+        while (merged) {
+            merged = false;
+            for (size_t i = 0; i < dirty.size() && !merged; i++) {
+                if (dirty[i].empty())
+                    continue;
+                for (size_t j = i + 1; j < dirty.size(); j++) {
+                    if (!dirty[j].empty() && !(dirty[i] & dirty[j]).empty()) {
+                        dirty[i] |= dirty[j];
+                        dirty[j] = cv::Rect();
+                        merged = true;
+                    }
+                }
+            }
+        }
+        size_t kept = 0;
+        for (const cv::Rect& r : dirty)
+            if (!r.empty())
+                dirty[kept++] = r;
+        dirty.resize(kept);
+    }
+
+    cv::Mat background; // Fundo do frame atual.
+    cv::Mat output; // Tela montada, mantida entre os frames.
+    std::vector<Item> items; // Itens deste frame.
+    std::vector<Item> previous; // Itens do frame anterior, como estão na tela.
+    std::vector<cv::Rect> dirty; // Regiões a refazer.
+    bool fullRedraw = true;
+    uint64_t touched = 0;
+};
@@ -0,0 +1,352 @@
+#include <opencv2/opencv.hpp> // Inclui a biblioteca OpenCV para manipulação de imagens e vídeos.
+#include <iostream> // Inclui a biblioteca de entrada/saída padrão do C++.
+#include <fstream> // CSV e JSON dos resultados.
+#include <vector> // Inclui a biblioteca para usar vetores dinâmicos.
+#include <string> // Inclui a classe string.
+#include <cstdio> // printf e snprintf da tabela.
+#include <cstdlib> // atof e atoi das listas de valores.
+#include <algorithm> // Ordena os tempos para os percentis.
+#include <filesystem> // Lista os vídeos de uma pasta.
+#include "face_tracker.hpp" // FaceTracker e ScaledFaceTracker.
+#include "haar_detector.hpp" // Cascade Haar paralelo com kernel SIMD.
+
+using namespace cv;
+using namespace std;
+
+// Ferramenta offline para escolher os parâmetros da detecção: roda uma grade de configurações
+// (scaleFactor, minNeighbors, minSize, redução e rastreamento por janela) sobre vídeos gravados e
+// mede vazão, latência e a concordância com uma detecção de referência, bem mais cara e mais completa.
+//
+//   ./detect_bench pasta|video.mp4 [--scale-factors 1.1,1.3,1.5] [--neighbors 2,4] [--min-sizes 50]
+//                  [--downscales 1,2] [--roi on,off] [--frames 300] [--size 1280x720]
+//                  [--csv resultados.csv] [--json resultados.json]
+
+// Uma configuração da grade.
+struct BenchConfig {
+    double scaleFactor = 1.1;
+    int minNeighbors = 3;
+    int minSize = 30; // Lado do menor rosto, em pixels do quadro.
+    double downscale = 1; // Redução antes do cascade (DetectionScaleParams::scale).
+    bool roi = true; // Rastreia numa janela em volta do último rosto (FaceTracker); false = quadro inteiro sempre.
+};
+
+// Resultado de uma configuração num vídeo (ou somado em todos).
+struct BenchResult {
+    string clip;
+    BenchConfig config;
+    vector<double> times; // ms de cada detecção (redução, equalização e cascade).
+    long found = 0; // Frames com rosto.
+    long referenceFaces = 0; // Frames com rosto na referência.
+    long matched = 0; // Frames com rosto nos dois e IoU > 0.5.
+    long extra = 0; // Frames com rosto só nesta configuração.
+    double iouSum = 0; // Soma do IoU nos frames com rosto nos dois.
+    long compared = 0;
+
+    void add(const BenchResult& other) {
+        times.insert(times.end(), other.times.begin(), other.times.end());
+        found += other.found;
+        referenceFaces += other.referenceFaces;
+        matched += other.matched;
+        extra += other.extra;
+        iouSum += other.iouSum;
+        compared += other.compared;
+    }
+};
+
+// Estatísticas de um resultado, já prontas para a tabela e os arquivos.
+struct BenchSummary {
+    long frames = 0;
+    double fps = 0, meanMs = 0, p50 = 0, p95 = 0, p99 = 0;
+    double foundPct = 0, recallPct = 0, extraPct = 0, meanIou = 0;
+};
+
+// Interseção sobre união de dois retângulos (0 = disjuntos, 1 = iguais).
+double iou(const Rect& a, const Rect& b) {
+    double inter = (a & b).area();
+    double uni = a.area() + b.area() - inter;
+    return uni > 0 ? inter / uni : 0;
+}
+
+double percentile(const vector<double>& sorted, double q) {
+    if (sorted.empty())
+        return 0;
+    return sorted[min((size_t)(q * (sorted.size() - 1) + 0.5), sorted.size() - 1)];
+}
+
+BenchSummary summarize(const BenchResult& r) {
+    BenchSummary s;
+    s.frames = (long)r.times.size();
+    if (s.frames == 0)
+        return s;
+    vector<double> sorted = r.times;
+    sort(sorted.begin(), sorted.end());
+    double total = 0;
+    for (double t : sorted)
+        total += t;
+    s.meanMs = total / s.frames;
+    s.fps = total > 0 ? s.frames * 1000.0 / total : 0;
+    s.p50 = percentile(sorted, 0.50);
+    s.p95 = percentile(sorted, 0.95);
+    s.p99 = percentile(sorted, 0.99);
+    s.foundPct = 100.0 * r.found / s.frames;
+    s.recallPct = r.referenceFaces ? 100.0 * r.matched / r.referenceFaces : 0;
+    s.extraPct = 100.0 * r.extra / s.frames;
+    s.meanIou = r.compared ? r.iouSum / r.compared : 0;
+    return s;
+}
+
+// Lista de números separados por vírgula ("1.1,1.3,1.5").
+vector<double> parseList(const string& text) {
+    vector<double> values;
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t end = text.find(',', start);
+        if (end == string::npos)
+            end = text.size();
+        string item = text.substr(start, end - start);
+        if (item == "on" || item == "off")
+            values.push_back(item == "on");
+        else if (!item.empty())
+            values.push_back(atof(item.c_str()));
+        start = end + 1;
+    }
+    return values;
+}
+
+// Um vídeo gravado, já decodificado e em cinza, para todas as configurações verem os mesmos quadros.
+struct Clip {
+    string name;
+    vector<Mat> gray;
+    vector<vector<Rect>> reference; // Rostos da detecção de referência em cada quadro.
+};
+
+bool loadClip(const string& path, long maxFrames, Size size, Clip& clip) {
+    VideoCapture cap(path);
+    if (!cap.isOpened())
+        return false;
+    clip.name = filesystem::path(path).filename().string();
+    Mat frame, resized;
+    while ((maxFrames <= 0 || (long)clip.gray.size() < maxFrames) && cap.read(frame)) {
+        if (!size.empty()) {
+            resize(frame, resized, size, 0, 0, INTER_AREA);
+            frame = resized;
+        }
+        Mat gray;
+        cvtColor(frame, gray, COLOR_BGR2GRAY);
+        clip.gray.push_back(gray);
+    }
+    return !clip.gray.empty();
+}
+
+// Referência: quadro inteiro equalizado, passos de escala pequenos e rostos pequenos, sem rastreamento.
+void detectReference(HaarDetector& detector, Clip& clip) {
+    Mat equalized;
+    clip.reference.resize(clip.gray.size());
+    for (size_t i = 0; i < clip.gray.size(); i++) {
+        equalizeHist(clip.gray[i], equalized);
+        detector.detectMultiScale(equalized, clip.reference[i], 1.05, 3, CASCADE_SCALE_IMAGE, Size(30, 30));
+    }
+}
+
+BenchResult runConfig(HaarDetector& detector, const BenchConfig& config, const Clip& clip) {
+    FaceTrackerParams params;
+    params.scaleFactor = config.scaleFactor;
+    params.minNeighbors = config.minNeighbors;
+    params.flags = CASCADE_SCALE_IMAGE;
+    params.minSize = Size(config.minSize, config.minSize);
+    params.redetectEvery = config.roi ? params.redetectEvery : 1; // A cada frame no quadro inteiro.
+    DetectionScaleParams scaling;
+    scaling.scale = config.downscale;
+    scaling.equalize = true; // Como no jogo.
+    ScaledFaceTracker tracker(detector, params, scaling);
+
+    BenchResult result;
+    result.clip = clip.name;
+    result.config = config;
+    result.times.reserve(clip.gray.size());
+    vector<Rect> faces;
+    for (size_t i = 0; i < clip.gray.size(); i++) {
+        tracker.detect(clip.gray[i], faces);
+        result.times.push_back(tracker.lastDetectionMs());
+        const vector<Rect>& reference = clip.reference[i];
+        result.found += !faces.empty();
+        result.referenceFaces += !reference.empty();
+        if (faces.empty())
+            continue;
+        if (reference.empty()) {
+            result.extra++;
+            continue;
+        }
+        double best = 0; // O rosto achado deve bater com algum dos rostos da referência.
+        for (const Rect& r : reference)
+            best = max(best, iou(r, faces[0]));
+        result.iouSum += best;
+        result.compared++;
+        result.matched += best > 0.5;
+    }
+    return result;
+}
+
+void configName(const BenchConfig& c, char* text, size_t size) {
+    snprintf(text, size, "sf %.2f viz %d min %d red %.1f %s", c.scaleFactor, c.minNeighbors, c.minSize, c.downscale,
+             c.roi ? "janela" : "inteiro");
+}
+
+void writeCsv(ostream& out, const vector<BenchResult>& results) {
+    out << "clip,scale_factor,min_neighbors,min_size,downscale,roi,frames,fps,mean_ms,p50_ms,p95_ms,p99_ms,found_pct,"
+           "recall_pct,extra_pct,mean_iou\n";
+    char line[512];
+    for (const BenchResult& r : results) {
+        BenchSummary s = summarize(r);
+        const BenchConfig& c = r.config;
+        snprintf(line, sizeof(line), "%s,%.3f,%d,%d,%.2f,%d,%ld,%.2f,%.3f,%.3f,%.3f,%.3f,%.2f,%.2f,%.2f,%.4f\n",
+                 r.clip.c_str(), c.scaleFactor, c.minNeighbors, c.minSize, c.downscale, (int)c.roi, s.frames, s.fps, s.meanMs,
+                 s.p50, s.p95, s.p99, s.foundPct, s.recallPct, s.extraPct, s.meanIou);
+        out << line;
+    }
+}
+
+void writeJson(ostream& out, const vector<BenchResult>& results) {
+    out << "[\n";
+    char line[1024];
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        BenchSummary s = summarize(r);
+        const BenchConfig& c = r.config;
+        string clip; // Nome do arquivo com aspas e barras escapadas.
+        for (char ch : r.clip) {
+            if (ch == '"' || ch == '\\')
+                clip += '\\';
+            clip += ch;
+        }
+        snprintf(line, sizeof(line),
+                 "  {\"clip\":\"%s\",\"scale_factor\":%.3f,\"min_neighbors\":%d,\"min_size\":%d,\"downscale\":%.2f,\"roi\":%s,"
+                 "\"frames\":%ld,\"fps\":%.2f,\"mean_ms\":%.3f,\"p50_ms\":%.3f,\"p95_ms\":%.3f,\"p99_ms\":%.3f,"
+                 "\"found_pct\":%.2f,\"recall_pct\":%.2f,\"extra_pct\":%.2f,\"mean_iou\":%.4f}%s\n",
+                 clip.c_str(), c.scaleFactor, c.minNeighbors, c.minSize, c.downscale, c.roi ? "true" : "false", s.frames, s.fps,
+                 s.meanMs, s.p50, s.p95, s.p99, s.foundPct, s.recallPct, s.extraPct, s.meanIou,
+                 i + 1 < results.size() ? "," : "");
+        out << line;
+    }
+    out << "]\n";
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        cout << "Uso: " << argv[0] << " pasta|video [--scale-factors 1.1,1.3,1.5] [--neighbors 2,4] [--min-sizes 50]"
+             << " [--downscales 1,2] [--roi on,off] [--frames 300] [--size LxA] [--csv arquivo.csv] [--json arquivo.json]" << endl;
+        return -1;
+    }
+    string source = argv[1];
+    vector<double> scaleFactors = { 1.1, 1.3, 1.5 }, neighbors = { 2, 4 }, minSizes = { 50 }, downscales = { 1, 2 },
+                   roiModes = { 1, 0 };
+    long maxFrames = 300; // Por vídeo; os quadros ficam todos na memória.
+    Size size; // Vazio = resolução do vídeo.
+    string csvFile, jsonFile;
+    for (int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--scale-factors" && hasValue)
+            scaleFactors = parseList(argv[++i]);
+        else if (arg == "--neighbors" && hasValue)
+            neighbors = parseList(argv[++i]);
+        else if (arg == "--min-sizes" && hasValue)
+            minSizes = parseList(argv[++i]);
+        else if (arg == "--downscales" && hasValue)
+            downscales = parseList(argv[++i]);
+        else if (arg == "--roi" && hasValue)
+            roiModes = parseList(argv[++i]);
+        else if (arg == "--frames" && hasValue)
+            maxFrames = atol(argv[++i]);
+        else if (arg == "--size" && hasValue) {
+            int width = 0, height = 0;
+            if (sscanf(argv[++i], "%dx%d", &width, &height) == 2)
+                size = Size(width, height);
+        } else if (arg == "--csv" && hasValue)
+            csvFile = argv[++i];
+        else if (arg == "--json" && hasValue)
+            jsonFile = argv[++i];
+        else {
+            cout << "Opção desconhecida: " << arg << endl;
+            return -1;
+        }
+    }
+
+    vector<string> paths;
+    if (filesystem::is_directory(source)) {
+        for (const auto& entry : filesystem::directory_iterator(source))
+            if (entry.is_regular_file())
+                paths.push_back(entry.path().string());
+        sort(paths.begin(), paths.end());
+    } else {
+        paths.push_back(source);
+    }
+
+    HaarDetector detector;
+    if (!detector.load("haarcascade_frontalface_default.xml")) {
+        cout << "Erro ao carregar o classificador de rosto!" << endl;
+        return -1;
+    }
+
+    vector<BenchConfig> configs;
+    for (double sf : scaleFactors)
+        for (double n : neighbors)
+            for (double m : minSizes)
+                for (double d : downscales)
+                    for (double roi : roiModes) {
+                        BenchConfig c;
+                        c.scaleFactor = sf;
+                        c.minNeighbors = (int)n;
+                        c.minSize = (int)m;
+                        c.downscale = d;
+                        c.roi = roi != 0;
+                        configs.push_back(c);
+                    }
+
+    vector<BenchResult> results; // Um por vídeo e configuração.
+    vector<BenchResult> totals(configs.size()); // Cada configuração somada em todos os vídeos.
+    int clips = 0;
+    for (const string& path : paths) {
+        Clip clip;
+        if (!loadClip(path, maxFrames, size, clip))
+            continue; // Não é um vídeo (ou está vazio).
+        clips++;
+        detectReference(detector, clip);
+        printf("%s: %zu quadros %dx%d\n", clip.name.c_str(), clip.gray.size(), clip.gray[0].cols, clip.gray[0].rows);
+        for (size_t k = 0; k < configs.size(); k++) {
+            results.push_back(runConfig(detector, configs[k], clip));
+            totals[k].add(results.back());
+        }
+    }
+    if (clips == 0) {
+        cout << "Nenhum vídeo lido de " << source << endl;
+        return -1;
+    }
+
+    printf("\n%-40s %8s %9s %9s %9s %9s %8s %8s %8s %8s\n", "configuracao (todos os videos)", "fps", "media(ms)", "p50(ms)",
+           "p95(ms)", "p99(ms)", "achados", "recall", "extras", "IoU");
+    char name[96];
+    for (size_t k = 0; k < configs.size(); k++) {
+        totals[k].clip = "*";
+        totals[k].config = configs[k];
+        BenchSummary s = summarize(totals[k]);
+        configName(configs[k], name, sizeof(name));
+        printf("%-40s %8.1f %9.2f %9.2f %9.2f %9.2f %7.0f%% %7.0f%% %7.0f%% %8.3f\n", name, s.fps, s.meanMs, s.p50, s.p95, s.p99,
+               s.foundPct, s.recallPct, s.extraPct, s.meanIou);
+    }
+
+    results.insert(results.end(), totals.begin(), totals.end()); // clip "*" = todos os vídeos.
+    if (!csvFile.empty()) {
+        ofstream out(csvFile);
+        writeCsv(out, results);
+        if (!out)
+            cout << "Erro ao gravar " << csvFile << endl;
+    }
+    if (!jsonFile.empty()) {
+        ofstream out(jsonFile);
+        writeJson(out, results);
+        if (!out)
+            cout << "Erro ao gravar " << jsonFile << endl;
+    }
+    return 0;
+}
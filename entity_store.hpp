@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstddef> // size_t.
+#include <cstdint> // uint8_t, uint32_t.
+#include <vector> // Colunas e tabelas de índices.
+
+/** @brief Tipo de cada entidade do jogo. */
+enum class EntityType : uint8_t { Shot, Target, Explosion };
+
+/**
+ * @brief Referência estável a uma entidade: continua apontando para ela mesmo depois
+ * que outras são removidas, e deixa de ser válida quando a própria entidade sai.
+ */
+struct EntityHandle {
+    uint32_t slot = UINT32_MAX; // Posição na tabela de slots.
+    uint32_t generation = 0; // Geração do slot quando o handle foi criado.
+};
+
+/**
+ * @brief Tiros, alvos e explosões guardados como estrutura de arrays.
+ *
+ * Cada campo é um vetor contíguo (x, y, vx, vy, ...) indexado pelo índice denso
+ * 0..size()-1, de modo que os laços de movimento e de colisão percorrem memória
+ * sequencial e o compilador consegue vetorizá-los.
+ *
+ * kill() só marca a entidade como morta; removeDead() tira as mortas de uma vez,
+ * trocando cada uma pela última e encolhendo os vetores (swap-and-pop, O(1) por
+ * remoção). Assim um laço pode matar entidades sem invalidar os índices que ainda
+ * vai visitar. Os índices densos mudam em removeDead(); para guardar uma referência
+ * entre ticks use handle(), que passa por uma tabela de slots com geração.
+ *
+ * Os vetores são públicos para leitura e para alterar valores; o tamanho só muda
+ * por spawn(), removeDead() e clear().
+ */
+class EntityStore {
+public:
+    std::vector<float> x, y; // Posição no tick atual.
+    std::vector<float> prevX, prevY; // Posição no tick anterior (para interpolar o desenho).
+    std::vector<float> vx, vy; // Velocidade, em px por tick.
+    std::vector<EntityType> type; // Tipo da entidade.
+    std::vector<uint8_t> alive; // 0 depois de kill(), até removeDead().
+
+    /** @brief Número de entidades nos vetores (inclui as mortas que ainda não saíram). */
+    size_t size() const {
+        return x.size();
+    }
+
+    /** @brief Entidades vivas de um tipo. */
+    size_t count(EntityType t) const {
+        return counts[(int)t];
+    }
+
+    /** @brief Cria uma entidade parada em prevX/prevY = x/y e devolve o seu handle. */
+    EntityHandle spawn(EntityType t, float px, float py, float pvx = 0, float pvy = 0) {
+        uint32_t slot;
+        if (!freeSlots.empty()) { // Reaproveita um slot liberado.
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            slot = (uint32_t)slotToDense.size();
+            slotToDense.push_back(0);
+            slotGeneration.push_back(0);
+        }
+        slotToDense[slot] = (uint32_t)x.size();
+        denseToSlot.push_back(slot);
+        x.push_back(px);
+        y.push_back(py);
+        prevX.push_back(px);
+        prevY.push_back(py);
+        vx.push_back(pvx);
+        vy.push_back(pvy);
+        type.push_back(t);
+        alive.push_back(1);
+        counts[(int)t]++;
+        return EntityHandle{ slot, slotGeneration[slot] };
+    }
+
+    /** @brief Handle da entidade no índice denso i. */
+    EntityHandle handle(size_t i) const {
+        uint32_t slot = denseToSlot[i];
+        return EntityHandle{ slot, slotGeneration[slot] };
+    }
+
+    /** @brief Índice denso atual da entidade, ou -1 se o handle não vale mais. */
+    long index(EntityHandle h) const {
+        if (h.slot >= slotToDense.size() || slotGeneration[h.slot] != h.generation)
+            return -1;
+        return (long)slotToDense[h.slot];
+    }
+
+    /** @brief Marca a entidade como morta; ela sai dos vetores no próximo removeDead(). */
+    void kill(size_t i) {
+        if (alive[i]) {
+            alive[i] = 0;
+            counts[(int)type[i]]--;
+        }
+    }
+
+    void kill(EntityHandle h) {
+        long i = index(h);
+        if (i >= 0)
+            kill((size_t)i);
+    }
+
+    /** @brief Guarda a posição atual em prevX/prevY e anda um tick com a velocidade. */
+    void step() {
+        size_t n = size();
+        float* px = x.data();
+        float* py = y.data();
+        float* ox = prevX.data();
+        float* oy = prevY.data();
+        const float* dx = vx.data();
+        const float* dy = vy.data();
+        for (size_t i = 0; i < n; i++) { // Laços separados e sem desvios: viram SIMD.
+            ox[i] = px[i];
+            px[i] += dx[i];
+        }
+        for (size_t i = 0; i < n; i++) {
+            oy[i] = py[i];
+            py[i] += dy[i];
+        }
+    }
+
+    /** @brief Remove as entidades mortas (swap-and-pop) e invalida os seus handles. */
+    void removeDead() {
+        for (size_t i = 0; i < size();) {
+            if (alive[i]) {
+                i++;
+                continue;
+            }
+            uint32_t slot = denseToSlot[i];
+            slotGeneration[slot]++; // Handles antigos deste slot deixam de valer.
+            freeSlots.push_back(slot);
+            size_t last = size() - 1;
+            if (i != last) { // A última entidade ocupa o lugar da removida.
+                x[i] = x[last];
+                y[i] = y[last];
+                prevX[i] = prevX[last];
+                prevY[i] = prevY[last];
+                vx[i] = vx[last];
+                vy[i] = vy[last];
+                type[i] = type[last];
+                alive[i] = alive[last];
+                denseToSlot[i] = denseToSlot[last];
+                slotToDense[denseToSlot[i]] = (uint32_t)i;
+            }
+            x.pop_back();
+            y.pop_back();
+            prevX.pop_back();
+            prevY.pop_back();
+            vx.pop_back();
+            vy.pop_back();
+            type.pop_back();
+            alive.pop_back();
+            denseToSlot.pop_back();
+            // Não avança i: a entidade que veio do fim ainda precisa ser conferida.
+        }
+    }
+
+    /** @brief Remove todas as entidades; os handles existentes deixam de valer. */
+    void clear() {
+        for (size_t i = 0; i < size(); i++)
+            alive[i] = 0;
+        removeDead();
+        for (size_t& c : counts)
+            c = 0;
+    }
+
+private:
+    std::vector<uint32_t> denseToSlot; // Slot de cada índice denso.
+    std::vector<uint32_t> slotToDense; // Índice denso de cada slot em uso.
+    std::vector<uint32_t> slotGeneration; // Incrementada quando o slot é liberado.
+    std::vector<uint32_t> freeSlots; // Slots livres para reaproveitar.
+    size_t counts[3] = {}; // Vivas por tipo.
+};
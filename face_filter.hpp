@@ -0,0 +1,95 @@
+#pragma once
+
+#include <opencv2/core.hpp> // Rect.
+#include <algorithm> // std::min, std::max.
+#include <cmath> // std::abs.
+
+/**
+ * @brief Parâmetros do FaceFilter.
+ */
+struct FaceFilterParams {
+    double alpha = 0.5; // Peso da medida na posição (1 = usa a detecção crua, sem suavizar).
+    double beta = 0.15; // Peso do erro na velocidade.
+    double sizeAlpha = 0.3; // Suavização da largura e da altura (não têm velocidade).
+    double maxPredictSeconds = 0.15; // Quanto a previsão anda além da última detecção; depois a posição para.
+    double maxCoastSeconds = 0.5; // Sem detecção por mais que isso, o rosto é dado como perdido.
+    double resetDistance = 1.0; // Salto maior que isso (em larguras do rosto) reinicia o filtro: é outro rosto.
+};
+
+/**
+ * @brief Filtro alfa-beta da posição do rosto, com as marcas de tempo das detecções.
+ *
+ * Guarda posição e velocidade do centro (x e y) e o tamanho. Cada detecção corrige
+ * a previsão feita para o instante dela: parte do erro vai para a posição (alpha) e
+ * parte para a velocidade (beta), o que tira o ruído da detecção sem o atraso de uma
+ * média simples. Entre as detecções, ou quando uma falha, predict() extrapola pela
+ * velocidade para qualquer instante, então a nave pode andar na taxa da tela (ou dos
+ * ticks) mesmo com a detecção rodando bem mais devagar.
+ *
+ * Os tempos são os das amostras (momento da captura), em segundos; o filtro não lê o
+ * relógio, então o replay continua reproduzível.
+ */
+class FaceFilter {
+public:
+    explicit FaceFilter(const FaceFilterParams& params = FaceFilterParams()) : params(params) {}
+
+    /** @brief Nova detecção do rosto, capturada no instante time. */
+    void update(const cv::Rect& face, double time) {
+        double cx = face.x + face.width * 0.5, cy = face.y + face.height * 0.5;
+        double dt = time - lastTime;
+        bool jump = valid && (std::abs(cx - x) > params.resetDistance * w || std::abs(cy - y) > params.resetDistance * h);
+        if (!valid || jump || time - lastSeen > params.maxCoastSeconds) { // Começa do zero.
+            x = cx;
+            y = cy;
+            vx = vy = 0;
+            w = face.width;
+            h = face.height;
+        } else if (dt <= 0) { // Mesmo instante da última correção: só a posição.
+            x += params.alpha * (cx - x);
+            y += params.alpha * (cy - y);
+        } else {
+            double px = x + vx * dt, py = y + vy * dt; // Previsão para o instante da medida.
+            double rx = cx - px, ry = cy - py; // Erro da previsão.
+            x = px + params.alpha * rx;
+            y = py + params.alpha * ry;
+            vx += params.beta * rx / dt;
+            vy += params.beta * ry / dt;
+            w += params.sizeAlpha * (face.width - w);
+            h += params.sizeAlpha * (face.height - h);
+        }
+        lastTime = lastSeen = time;
+        valid = true;
+    }
+
+    /** @brief A detecção do instante time não achou o rosto: a previsão continua até maxCoastSeconds. */
+    void miss(double time) {
+        if (valid && time - lastSeen > params.maxCoastSeconds)
+            valid = false;
+    }
+
+    /**
+     * @brief Rosto previsto para o instante time.
+     * @return false se não há rosto (nunca visto ou perdido há mais de maxCoastSeconds).
+     */
+    bool predict(double time, cv::Rect& face) const {
+        if (!valid || time - lastSeen > params.maxCoastSeconds)
+            return false;
+        double dt = std::min(std::max(time - lastTime, 0.0), params.maxPredictSeconds);
+        double cx = x + vx * dt, cy = y + vy * dt;
+        face = cv::Rect(cvRound(cx - w * 0.5), cvRound(cy - h * 0.5), cvRound(w), cvRound(h));
+        return true;
+    }
+
+    void reset() {
+        valid = false;
+    }
+
+private:
+    FaceFilterParams params;
+    bool valid = false; // Tem um rosto.
+    double x = 0, y = 0; // Centro, no instante lastTime.
+    double vx = 0, vy = 0; // Velocidade do centro, em px/s.
+    double w = 0, h = 0; // Tamanho suavizado.
+    double lastTime = 0; // Instante da última correção.
+    double lastSeen = 0; // Instante da última detecção com rosto.
+};
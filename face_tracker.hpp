@@ -0,0 +1,335 @@
+#pragma once
+
+#include <opencv2/core.hpp> // Mat, Rect e tipos básicos do OpenCV.
+#include <opencv2/imgproc.hpp> // resize e equalizeHist da detecção reduzida.
+#include <opencv2/objdetect.hpp> // CascadeClassifier.
+#include <algorithm> // std::max, std::min.
+#include <cmath> // std::abs.
+#include <cstdint> // int64_t.
+#include <vector> // Lista de rostos.
+#include "haar_detector.hpp" // Cascade Haar paralelo com kernel SIMD.
+
+/**
+ * @brief Parâmetros do FaceTracker: os do detectMultiScale e os do rastreamento.
+ */
+struct FaceTrackerParams {
+    double scaleFactor = 1.1; // Como em detectMultiScale.
+    int minNeighbors = 3; // Como em detectMultiScale.
+    int flags = 0; // Como em detectMultiScale.
+    cv::Size minSize; // Menor rosto aceito na detecção da imagem inteira.
+    cv::Size maxSize; // Maior rosto aceito na detecção da imagem inteira.
+    double roiMargin = 0.5; // Quanto a janela de busca cresce em volta do último rosto (fração do tamanho dele, por lado).
+    double sizeRange = 0.3; // Variação de tamanho aceita entre um frame e outro (0.3 = de 70% a 130%).
+    int maxMisses = 3; // Falhas seguidas na janela antes de voltar para a imagem inteira.
+    int redetectEvery = 30; // A cada quantos frames refazer a busca na imagem inteira mesmo rastreando (0 = nunca).
+};
+
+/**
+ * @brief Detecção de rosto em dois modos: busca na imagem inteira e rastreamento.
+ *
+ * A primeira detecção (aquisição) roda o cascade no quadro inteiro. Depois disso a
+ * busca é feita só numa janela em volta do último rosto, e só em escalas próximas
+ * do tamanho dele, o que corta a maior parte das janelas avaliadas. Depois de
+ * maxMisses falhas seguidas, ou a cada redetectEvery frames, volta a procurar no
+ * quadro inteiro.
+ *
+ * Os programas só usam faces[0]; o tracker devolve no máximo um rosto, que é o
+ * mais próximo do rastreado.
+ *
+ * Funciona tanto com o CascadeClassifier do OpenCV quanto com o HaarDetector.
+ */
+class FaceTracker {
+public:
+    struct Stats {
+        long frames = 0; // Chamadas a detect().
+        long fullScans = 0; // Buscas na imagem inteira.
+        long roiScans = 0; // Buscas só na janela.
+        long misses = 0; // Buscas na janela que não acharam nada.
+        double totalMs = 0; // Tempo total gasto no cascade.
+    };
+
+    FaceTracker(cv::CascadeClassifier& cascade, const FaceTrackerParams& params = FaceTrackerParams())
+        : cascade(&cascade), params(params) {}
+
+    FaceTracker(HaarDetector& detector, const FaceTrackerParams& params = FaceTrackerParams())
+        : haar(&detector), params(params) {}
+
+    /**
+     * @brief Procura o rosto no quadro em escala de cinza.
+     * @param gray quadro CV_8UC1 (já equalizado, se o programa equaliza).
+     * @param faces recebe zero ou um rosto, em coordenadas do quadro inteiro.
+     * @return true se achou um rosto.
+     */
+    bool detect(const cv::Mat& gray, std::vector<cv::Rect>& faces) {
+        int64_t start = cv::getTickCount();
+        stats.frames++;
+        framesSinceFull++;
+        bool full = !tracking || (params.redetectEvery > 0 && framesSinceFull >= params.redetectEvery);
+        if (!full && !detectInRoi(gray, faces)) {
+            stats.misses++;
+            if (++misses >= params.maxMisses) { // Perdeu o rosto: volta para a imagem inteira já neste frame.
+                tracking = false;
+                full = true;
+            }
+        }
+        if (full)
+            detectFull(gray, faces);
+        stats.totalMs += (cv::getTickCount() - start) * 1000.0 / cv::getTickFrequency();
+        return !faces.empty();
+    }
+
+    /** @brief Esquece o rosto rastreado; a próxima chamada busca na imagem inteira. */
+    void reset() {
+        tracking = false;
+        misses = 0;
+    }
+
+    bool isTracking() const {
+        return tracking;
+    }
+
+    cv::Rect lastFace() const {
+        return last;
+    }
+
+    const Stats& statistics() const {
+        return stats;
+    }
+
+    const FaceTrackerParams& parameters() const {
+        return params;
+    }
+
+    /** @brief Troca o menor e o maior rosto aceitos na busca da imagem inteira. */
+    void setSizeLimits(cv::Size minSize, cv::Size maxSize) {
+        params.minSize = minSize;
+        params.maxSize = maxSize;
+    }
+
+    /**
+     * @brief Avisa que as próximas imagens vêm numa escala diferente (nova = antiga * factor),
+     * sem perder o rosto rastreado.
+     */
+    void rescale(double factor) {
+        last = cv::Rect(cvRound(last.x * factor), cvRound(last.y * factor), cvRound(last.width * factor),
+                        cvRound(last.height * factor));
+    }
+
+private:
+    void detectFull(const cv::Mat& gray, std::vector<cv::Rect>& faces) {
+        stats.fullScans++;
+        framesSinceFull = 0;
+        runCascade(gray, params.minSize, params.maxSize);
+        faces.clear();
+        if (found.empty()) {
+            tracking = false;
+            return;
+        }
+        // Rastreando: prefere o rosto mais perto do anterior; senão, o primeiro (como faces[0]).
+        accept(tracking ? closest(found) : found[0], faces);
+    }
+
+    bool detectInRoi(const cv::Mat& gray, std::vector<cv::Rect>& faces) {
+        stats.roiScans++;
+        int mx = (int)(last.width * params.roiMargin), my = (int)(last.height * params.roiMargin);
+        cv::Rect roi = cv::Rect(last.x - mx, last.y - my, last.width + 2 * mx, last.height + 2 * my)
+                     & cv::Rect(0, 0, gray.cols, gray.rows);
+        faces.clear();
+        if (roi.width < last.width || roi.height < last.height)
+            return false; // O rosto saiu parcialmente do quadro.
+
+        int side = std::max(last.width, last.height);
+        int lo = std::max((int)(side * (1.0 - params.sizeRange)), std::max(params.minSize.width, 1));
+        int hi = std::max((int)(side * (1.0 + params.sizeRange)), lo + 1);
+        hi = std::max(std::min(hi, std::min(roi.width, roi.height)), lo);
+        runCascade(gray(roi), cv::Size(lo, lo), cv::Size(hi, hi));
+        if (found.empty())
+            return false;
+        for (cv::Rect& r : found) { // Volta para as coordenadas do quadro inteiro.
+            r.x += roi.x;
+            r.y += roi.y;
+        }
+        accept(closest(found), faces);
+        return true;
+    }
+
+    void runCascade(const cv::Mat& image, cv::Size minSize, cv::Size maxSize) {
+        if (haar)
+            haar->detectMultiScale(image, found, params.scaleFactor, params.minNeighbors, params.flags, minSize, maxSize);
+        else
+            cascade->detectMultiScale(image, found, params.scaleFactor, params.minNeighbors, params.flags, minSize, maxSize);
+    }
+
+    cv::Rect closest(const std::vector<cv::Rect>& candidates) const {
+        cv::Point center(last.x + last.width / 2, last.y + last.height / 2);
+        cv::Rect best = candidates[0];
+        long bestDistance = -1;
+        for (const cv::Rect& r : candidates) {
+            long dx = r.x + r.width / 2 - center.x, dy = r.y + r.height / 2 - center.y;
+            long distance = dx * dx + dy * dy;
+            if (bestDistance < 0 || distance < bestDistance) {
+                bestDistance = distance;
+                best = r;
+            }
+        }
+        return best;
+    }
+
+    void accept(const cv::Rect& face, std::vector<cv::Rect>& faces) {
+        last = face;
+        tracking = true;
+        misses = 0;
+        faces.push_back(face);
+    }
+
+    cv::CascadeClassifier* cascade = nullptr; // Um dos dois detectores é usado.
+    HaarDetector* haar = nullptr;
+    FaceTrackerParams params;
+    std::vector<cv::Rect> found; // Reaproveitado entre chamadas.
+    cv::Rect last; // Último rosto aceito.
+    bool tracking = false; // Tem um rosto para rastrear.
+    int misses = 0; // Falhas seguidas na janela.
+    int framesSinceFull = 0; // Frames desde a última busca na imagem inteira.
+    Stats stats;
+};
+
+/**
+ * @brief Resolução da detecção do ScaledFaceTracker.
+ */
+struct DetectionScaleParams {
+    double scale = 1; // Reduz a imagem por este fator (1 = resolução cheia) antes do cascade.
+    cv::Rect crop; // Parte do quadro em que se procura, em coordenadas do quadro (vazio = tudo).
+    bool equalize = false; // Equaliza o histograma já na imagem reduzida (mais barato que no quadro inteiro).
+    double budgetMs = 0; // Tempo alvo por detecção; > 0 escolhe a escala sozinho, entre minScale e maxScale.
+    double minScale = 1;
+    double maxScale = 4;
+    int adaptEvery = 15; // Detecções entre dois ajustes da escala automática.
+};
+
+/**
+ * @brief FaceTracker numa versão reduzida (e opcionalmente recortada) do quadro.
+ *
+ * O cascade custa mais ou menos proporcional à área da imagem, então detectar com
+ * scale = 2 custa perto de um quarto. Os rostos voltam para as coordenadas do quadro
+ * em ponto flutuante; como cada pixel da imagem reduzida vale scale pixels do quadro,
+ * variações menores que isso (ruído de arredondamento) são suavizadas pela média com a
+ * posição anterior, e a nave não treme de scale em scale pixels.
+ *
+ * Com budgetMs > 0 a escala é escolhida pelo tempo médio das últimas detecções:
+ * aumenta se passar do alvo e diminui se sobrar bastante folga.
+ */
+class ScaledFaceTracker {
+public:
+    ScaledFaceTracker(cv::CascadeClassifier& cascade, const FaceTrackerParams& params = FaceTrackerParams(),
+                      const DetectionScaleParams& scaling = DetectionScaleParams())
+        : tracker(cascade, params), base(params), scaling(scaling) {
+        setScale(scaling.scale);
+    }
+
+    ScaledFaceTracker(HaarDetector& detector, const FaceTrackerParams& params = FaceTrackerParams(),
+                      const DetectionScaleParams& scaling = DetectionScaleParams())
+        : tracker(detector, params), base(params), scaling(scaling) {
+        setScale(scaling.scale);
+    }
+
+    /**
+     * @brief Procura o rosto no quadro em escala de cinza, na resolução cheia.
+     * @param faces recebe zero ou um rosto, em coordenadas do quadro.
+     * @return true se achou um rosto.
+     */
+    bool detect(const cv::Mat& gray, std::vector<cv::Rect>& faces) {
+        int64_t start = cv::getTickCount();
+        cv::Rect area = cv::Rect(0, 0, gray.cols, gray.rows);
+        if (!scaling.crop.empty())
+            area &= scaling.crop;
+        if (area.empty()) { // Recorte fora do quadro.
+            faces.clear();
+            return false;
+        }
+        cv::Mat region = gray(area);
+        cv::Size size(std::max(1, cvRound(area.width / scale)), std::max(1, cvRound(area.height / scale)));
+        const cv::Mat* image = &region;
+        if (size != area.size()) {
+            cv::resize(region, small, size, 0, 0, cv::INTER_AREA); // Buffer reaproveitado.
+            image = &small;
+        }
+        if (scaling.equalize) {
+            cv::equalizeHist(*image, small); // Sem escrever no quadro de quem chamou.
+            image = &small;
+        }
+        tracker.detect(*image, found);
+
+        faces.clear();
+        if (found.empty()) {
+            hasSmooth = false;
+        } else {
+            double fx = (double)area.width / size.width, fy = (double)area.height / size.height;
+            const cv::Rect& r = found[0];
+            double next[4] = { area.x + (r.x + r.width * 0.5) * fx, area.y + (r.y + r.height * 0.5) * fy, r.width * fx,
+                               r.height * fy }; // Centro e tamanho, no quadro.
+            for (int k = 0; k < 4; k++) { // Dentro de um pixel reduzido é arredondamento: faz a média (sem redução, nada muda).
+                double quantum = k % 2 ? fy : fx;
+                smooth[k] = hasSmooth && quantum > 1 && std::abs(next[k] - smooth[k]) <= quantum ? (smooth[k] + next[k]) * 0.5 : next[k];
+            }
+            hasSmooth = true;
+            faces.push_back(cv::Rect(cvRound(smooth[0] - smooth[2] * 0.5), cvRound(smooth[1] - smooth[3] * 0.5),
+                                     cvRound(smooth[2]), cvRound(smooth[3])));
+        }
+        lastMs = (cv::getTickCount() - start) * 1000.0 / cv::getTickFrequency();
+        if (scaling.budgetMs > 0)
+            adapt();
+        return !faces.empty();
+    }
+
+    /** @brief Fator de redução em uso. */
+    double currentScale() const {
+        return scale;
+    }
+
+    /** @brief Tempo da última detecção (redução, equalização e cascade), em ms. */
+    double lastDetectionMs() const {
+        return lastMs;
+    }
+
+    const FaceTracker& faceTracker() const {
+        return tracker;
+    }
+
+private:
+    void setScale(double next) {
+        next = std::min(std::max(next, 1.0), std::max(scaling.maxScale, 1.0));
+        tracker.rescale(scale / next); // O rosto rastreado passa para a nova escala.
+        scale = next;
+        auto shrink = [next](cv::Size s) {
+            return s.empty() ? s : cv::Size(std::max(1, cvRound(s.width / next)), std::max(1, cvRound(s.height / next)));
+        };
+        tracker.setSizeLimits(shrink(base.minSize), shrink(base.maxSize));
+    }
+
+    // Média móvel do tempo; a cada adaptEvery detecções, um passo de 1.25x para cima ou para baixo.
+    void adapt() {
+        averageMs = samples == 0 ? lastMs : averageMs * 0.8 + lastMs * 0.2;
+        if (++samples < scaling.adaptEvery)
+            return;
+        const double step = 1.25; // O custo muda com a área: step^2 por passo.
+        if (averageMs > scaling.budgetMs && scale < scaling.maxScale)
+            setScale(scale * step);
+        else if (averageMs * step * step < scaling.budgetMs * 0.7 && scale > scaling.minScale)
+            setScale(std::max(scale / step, scaling.minScale));
+        else
+            return;
+        samples = 0; // Tempo medido de novo na escala nova.
+    }
+
+    FaceTracker tracker;
+    FaceTrackerParams base; // Tamanhos mínimo e máximo na resolução cheia.
+    DetectionScaleParams scaling;
+    double scale = 1;
+    cv::Mat small; // Imagem reduzida/equalizada, reaproveitada.
+    std::vector<cv::Rect> found; // Rosto na imagem reduzida.
+    double smooth[4] = { 0, 0, 0, 0 }; // Centro x, y, largura e altura suavizados, no quadro.
+    bool hasSmooth = false;
+    double lastMs = 0;
+    double averageMs = 0;
+    int samples = 0;
+};
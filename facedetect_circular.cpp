@@ -3,6 +3,10 @@
 #include "opencv2/imgproc.hpp"
 #include "opencv2/videoio.hpp"
 #include <iostream>
+#include "asset_cache.hpp"
+#include "profiler.hpp"
+#include "compositing.hpp"
+#include "batch_detect.hpp" // Modo lote: muitos vídeos em paralelo, sem janela.
 
 using namespace std;
 using namespace cv;
@@ -10,9 +14,13 @@ using namespace cv;
 void detectAndDraw( Mat& img, CascadeClassifier& cascade, double scale, bool tryflip);
 
 string cascadeName;
+AssetCache assets(true); // Imagens e sprites decodificados uma vez, recarregados quando o arquivo muda.
 
 int main( int argc, const char** argv )
 {
+    if (argc > 1 && string(argv[1]) == "--batch") // ./a.out --batch saida.csv videos... : rostos de cada quadro em CSV.
+        return batchMain(argc, argv);
+
     VideoCapture capture;
     Mat frame;
     bool tryflip;
@@ -42,7 +50,10 @@ int main( int argc, const char** argv )
 
         while (1)
         {
-            capture >> frame;
+            {
+                PROFILE_SCOPE("captura");
+                capture >> frame;
+            }
             if( frame.empty() )
                 break;
 
@@ -54,28 +65,12 @@ int main( int argc, const char** argv )
         }
     }
 
+    assets.printStats(cout);
+    for (const Profiler::StageStats& s : Profiler::instance().stats()) // Tempos por etapa (ultimos frames), em ms.
+        printf("%-14s p50 %7.2f  p95 %7.2f  p99 %7.2f\n", s.name.c_str(), s.p50, s.p95, s.p99);
     return 0;
 }
 
-/**
- * @brief Draws a transparent image over a frame Mat.
- * 
- * @param frame the frame where the transparent image will be drawn
- * @param transp the Mat image with transparency, read from a PNG image, with the IMREAD_UNCHANGED flag
- * @param xPos x position of the frame image where the image will start.
- * @param yPos y position of the frame image where the image will start.
- */
-void drawTransparency(Mat frame, Mat transp, int xPos, int yPos) {
-    Mat mask;
-    vector<Mat> layers;
-
-    split(transp, layers); // seperate channels
-    Mat rgb[3] = { layers[0],layers[1],layers[2] };
-    mask = layers[3]; // png's alpha channel used as mask
-    merge(rgb, 3, transp);  // put together the RGB channels, now transp insn't transparent 
-    transp.copyTo(frame.rowRange(yPos, yPos + transp.rows).colRange(xPos, xPos + transp.cols), mask);
-}
-
 /**
  * @brief Draws a transparent rect over a frame Mat.
  * 
@@ -85,24 +80,17 @@ void drawTransparency(Mat frame, Mat transp, int xPos, int yPos) {
  * @param regin rect region where the should be positioned
  */
 void drawTransRect(Mat frame, Scalar color, double alpha, Rect region) {
-    Mat roi = frame(region);
-    Mat rectImg(roi.size(), CV_8UC3, color); 
-    addWeighted(rectImg, alpha, roi, 1.0 - alpha , 0, roi); 
+    blendColorRect(frame, region, color, alpha); // Uma passada no próprio quadro, sem o Mat da cor.
 }
 
 
 void drawCircularImage(Mat bg, Mat dest, int &shift) {
     if (shift > dest.cols)
         shift = 0;
-    printf("bg::width: %d, height=%d\n", bg.cols, bg.rows );
-    printf("smallImg::width: %d, height=%d\n", dest.cols, dest.rows );
     Rect crop1(shift, 0, bg.cols - shift, bg.rows);
     Mat bg1 = bg(crop1);
     Rect crop2(0, 0, shift, bg.rows);
     Mat bg2 = bg(crop2);
-    printf("bg1::width: %d, height=%d\n", bg1.cols, bg1.rows );
-    printf("bg2::width: %d, height=%d\n", bg2.cols, bg2.rows );
-    printf("shift = %d \n", shift);
     if (bg1.cols > 0)
         bg1.copyTo(dest.rowRange(0, bg1.rows).colRange(0, bg1.cols));
     if (bg2.cols > 0)
@@ -111,7 +99,6 @@ void drawCircularImage(Mat bg, Mat dest, int &shift) {
 
 void detectAndDraw( Mat& img, CascadeClassifier& cascade, double scale, bool tryflip)
 {
-    double t = 0;
     vector<Rect> faces;
     Mat gray, smallImg;
     Scalar color = Scalar(255,0,0);
@@ -120,25 +107,34 @@ void detectAndDraw( Mat& img, CascadeClassifier& cascade, double scale, bool try
     resize( img, smallImg, Size(), fx, fx, INTER_LINEAR_EXACT );
     if( tryflip )
         flip(smallImg, smallImg, 1);
-    cvtColor( smallImg, gray, COLOR_BGR2GRAY );
-    equalizeHist( gray, gray );
-
-    t = (double)getTickCount();
+    {
+        PROFILE_SCOPE("cvtColor");
+        cvtColor( smallImg, gray, COLOR_BGR2GRAY );
+    }
+    {
+        PROFILE_SCOPE("equalizeHist");
+        equalizeHist( gray, gray );
+    }
 
     static int x = 0;
     // Desenha BG
-    Mat bg = cv::imread("flap.jpg", IMREAD_UNCHANGED);
-    drawCircularImage(bg, smallImg, x);
+    {
+        PROFILE_SCOPE("fundo");
+        AssetCache::ImageHandle bg = assets.image("flap.jpg", Size(), IMREAD_UNCHANGED); // Tamanho original, como antes do cache.
+        if (bg)
+            drawCircularImage(*bg, smallImg, x);
+    }
     x+=20;
 
-    cascade.detectMultiScale( gray, faces,
-        1.3, 2, 0
-        //|CASCADE_FIND_BIGGEST_OBJECT	
-        //|CASCADE_DO_ROUGH_SEARCH
-        |CASCADE_SCALE_IMAGE,
-        Size(40, 40) );
-    t = (double)getTickCount() - t;
-    printf( "detection time = %g ms\n", t*1000/getTickFrequency());
+    {
+        PROFILE_SCOPE("deteccao");
+        cascade.detectMultiScale( gray, faces,
+            1.3, 2, 0
+            //|CASCADE_FIND_BIGGEST_OBJECT	
+            //|CASCADE_DO_ROUGH_SEARCH
+            |CASCADE_SCALE_IMAGE,
+            Size(40, 40) );
+    }
     // PERCORRE AS FACES ENCONTRADAS
     for ( size_t i = 0; i < faces.size(); i++ )
     {
@@ -150,9 +146,9 @@ void detectAndDraw( Mat& img, CascadeClassifier& cascade, double scale, bool try
 
 
     // Desenha uma imagem
-    Mat orange = cv::imread("orange.png", IMREAD_UNCHANGED);
-    drawTransparency(smallImg, orange, 10, 150);
-    printf("orang::width: %d, height=%d\n", orange.cols, orange.rows );
+    AssetCache::SpriteHandle orange = assets.sprite("orange.png");
+    if (orange)
+        drawSprite(smallImg, *orange, 10, 150);
 
     // Desenha quadrados com transparencia
     double alpha = 0.3;
@@ -164,6 +160,6 @@ void detectAndDraw( Mat& img, CascadeClassifier& cascade, double scale, bool try
     putText	(smallImg, "Placar:", Point(300, 50), FONT_HERSHEY_PLAIN, 2, color); // fonte
 
     // Desenha o frame na tela
+    PROFILE_SCOPE("imshow");
     imshow("result", smallImg );
-    printf("image::width: %d, height=%d\n", smallImg.cols, smallImg.rows );
 }
@@ -7,6 +7,9 @@
 #include "opencv2/videoio.hpp"
 #include <opencv2/freetype.hpp>
 #include <iostream>
+#include "asset_cache.hpp"
+#include "compositing.hpp"
+#include "batch_detect.hpp" // Modo lote: muitos vídeos em paralelo, sem janela.
 
 using namespace std;
 using namespace cv;
@@ -17,9 +20,13 @@ void detectAndDraw( Mat& frame, CascadeClassifier& cascade, double scale, bool t
 
 string cascadeName;
 string wName = "Game";
+AssetCache assets(true); // Imagens, sprites e fontes carregados uma vez, recarregados quando o arquivo muda.
 
 int main( int argc, const char** argv )
 {
+    if (argc > 1 && string(argv[1]) == "--batch") // ./a.out --batch saida.csv videos... : rostos de cada quadro em CSV.
+        return batchMain(argc, argv);
+
     VideoCapture capture;
     Mat frame;
     bool tryflip;
@@ -83,35 +90,10 @@ int main( int argc, const char** argv )
 
     }
 
+    assets.printStats(cout);
     return 0;
 }
 
-/**
- * @brief Draws a transparent image over a frame Mat.
- * 
- * @param frame the frame where the transparent image will be drawn
- * @param transp the Mat image with transparency, read from a PNG image, with the IMREAD_UNCHANGED flag
- * @param xPos x position of the frame image where the image will start.
- * @param yPos y position of the frame image where the image will start.
- */
-void drawImage(Mat frame, Mat img, int xPos, int yPos) {
-    if (yPos + img.rows >= frame.rows || xPos + img.cols >= frame.cols)
-        return;
-
-    Mat mask;
-    vector<Mat> layers;
-
-    split(img, layers); // seperate channels
-    if (layers.size() == 4) { // img com transparencia.
-        Mat rgb[3] = { layers[0],layers[1],layers[2] };
-        mask = layers[3]; // png's alpha channel used as mask
-        merge(rgb, 3, img);  // put together the RGB channels, now transp insn't transparent 
-        img.copyTo(frame.rowRange(yPos, yPos + img.rows).colRange(xPos, xPos + img.cols), mask);
-    } else {
-        img.copyTo(frame.rowRange(yPos, yPos + img.rows).colRange(xPos, xPos + img.cols));
-    }
-}
-
 /**
  * @brief Draws a transparent rect over a frame Mat.
  * 
@@ -121,15 +103,14 @@ void drawImage(Mat frame, Mat img, int xPos, int yPos) {
  * @param regin rect region where the should be positioned
  */
 void drawTransRect(Mat frame, Scalar color, double alpha, Rect region) {
-    Mat roi = frame(region);
-    Mat rectImg(roi.size(), CV_8UC3, color); 
-    addWeighted(rectImg, alpha, roi, 1.0 - alpha , 0, roi); 
+    blendColorRect(frame, region, color, alpha); // Uma passada no próprio quadro, sem o Mat da cor.
 }
 
 void detectAndDraw( Mat& frame, CascadeClassifier& cascade, double scale, bool tryflip)
 {
-    vector<Rect> faces;
-    Mat grayFrame, smallFrame;
+    // Buffers mantidos entre as chamadas: com o mesmo tamanho de quadro, nada é realocado.
+    static vector<Rect> faces;
+    static Mat grayFrame, smallFrame;
     Scalar color = Scalar(255,0,0);
 
     double fx = 1 / scale;
@@ -149,18 +130,14 @@ void detectAndDraw( Mat& frame, CascadeClassifier& cascade, double scale, bool t
         Size(40, 40) );
 
 // Desenha uma o cenário 1
-    Mat fundo = cv::imread("cenario_Terra.png", IMREAD_UNCHANGED), img2;
-    printf("img::width: %d, height=%d\n", fundo.cols, fundo.rows );
-    if (fundo.rows > 200 || fundo.cols > 200)
-        resize( fundo, fundo, Size(639, 359));
-    drawImage(smallFrame, fundo, x, y);
+    // Os assets vêm do cache: decodificados, redimensionados e pré-multiplicados uma vez só.
+    AssetCache::SpriteHandle fundo = assets.sprite("cenario_Terra.png", Size(639, 359));
+    if (fundo)
+        drawSprite(smallFrame, *fundo, x, y);
 
       // Desenha a nave
-    Mat img = cv::imread("nave.png", IMREAD_UNCHANGED), img3;
-    printf("img::width: %d, height=%d\n", img.cols, img.rows );
-    if (img.rows > 200 || img.cols > 200)
-        resize( img, img, Size(30, 37));
-    //drawImage(smallFrame, img, x, y);
+    AssetCache::SpriteHandle img = assets.sprite("nave.png", Size(30, 37));
+    //drawSprite(smallFrame, *img, x, y);
     
 
     // PERCORRE AS FACES ENCONTRADAS
@@ -170,7 +147,8 @@ void detectAndDraw( Mat& frame, CascadeClassifier& cascade, double scale, bool t
 //        rectangle( smallFrame, Point(cvRound(r.x), cvRound(r.y)),
 //                    Point(cvRound((r.x + r.width-1)), cvRound((r.y + r.height-1))),
 //                    color, 3);
-        drawImage(smallFrame, img, r.x+60, r.y+10);
+        if (img)
+            drawSprite(smallFrame, *img, r.x+60, r.y+10);
         break;
     }
 
@@ -179,15 +157,14 @@ void detectAndDraw( Mat& frame, CascadeClassifier& cascade, double scale, bool t
     //drawTransRect(smallFrame, Scalar(0,0,255), alpha, Rect(  0, 0, 640, 360)); 
    // drawTransRect(smallFrame, Scalar(255,0,0), alpha, Rect(  200, 0, 200, 200));
 
-    // Desenha um texto e carrega a fonte arcadeclassic.ttf
-   cv::Ptr<cv::freetype::FreeType2> ft2 = cv::freetype::createFreeType2();
- 
-   ft2->loadFontData("arcadeclassic.ttf", 0);
+    // Desenha um texto com a fonte arcadeclassic.ttf (carregada uma vez pelo cache)
+   AssetCache::FontHandle ft2 = assets.font("arcadeclassic.ttf");
 
    // Define a cor do texto
    color = Scalar(255, 255, 255);
 
-   ft2->putText(smallFrame, "CI Invading Space:", Point(170, 50), 20, color, cv::FILLED, cv::LINE_AA, true);
+   if (ft2)
+       ft2->putText(smallFrame, "CI Invading Space:", Point(170, 50), 20, color, cv::FILLED, cv::LINE_AA, true);
 
 
     // Desenha o frame na tela
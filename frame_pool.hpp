@@ -0,0 +1,61 @@
+#pragma once
+
+#include <opencv2/core.hpp> // Mat e CV_XADD.
+#include <cstdint> // uint64_t.
+#include <vector> // Buffers do pool.
+
+/**
+ * @brief Conjunto fixo de buffers de imagem reaproveitados entre frames.
+ *
+ * acquire() devolve (sem copiar) um buffer que só o pool referencia, já no tamanho
+ * e tipo pedidos. Quem recebe pode passá-lo adiante para outras threads à vontade:
+ * o buffer volta a ficar livre sozinho quando a última cópia do Mat é liberada, pela
+ * contagem de referências do próprio OpenCV. Com o tamanho do quadro estável e buffers
+ * suficientes para tudo o que fica em trânsito, nenhum quadro novo é alocado.
+ *
+ * Só uma thread pode chamar acquire(); as outras apenas seguram e soltam os Mats.
+ */
+class FramePool {
+public:
+    /**
+     * @param capacity número de buffers (quadros que podem estar em uso ao mesmo tempo).
+     */
+    explicit FramePool(size_t capacity = 8) : slots(capacity) {}
+
+    /** @brief Buffer livre de tamanho size e tipo type (o conteúdo é o do uso anterior). */
+    cv::Mat acquire(cv::Size size, int type) {
+        for (size_t k = 0; k < slots.size(); k++) {
+            size_t i = (next + k) % slots.size();
+            cv::Mat& slot = slots[i];
+            if (inUse(slot))
+                continue;
+            next = i + 1;
+            if (slot.size() != size || slot.type() != type) {
+                slot.create(size, type); // Primeiro uso ou mudança de tamanho.
+                allocations++;
+            }
+            return slot;
+        }
+        // Todos em uso: quem está com o mais antigo fica com ele, e o pool aloca outro.
+        cv::Mat& slot = slots[next % slots.size()];
+        next++;
+        slot = cv::Mat(size, type);
+        allocations++;
+        return slot;
+    }
+
+    /** @brief Quantos buffers foram alocados até agora (para de crescer em regime). */
+    uint64_t allocated() const {
+        return allocations;
+    }
+
+private:
+    // O pool guarda uma referência; mais de uma quer dizer que alguém ainda usa o buffer.
+    static bool inUse(const cv::Mat& m) {
+        return m.u && CV_XADD(&m.u->refcount, 0) > 1;
+    }
+
+    std::vector<cv::Mat> slots;
+    size_t next = 0; // Por onde começar a procurar (o menos usado recentemente).
+    uint64_t allocations = 0;
+};
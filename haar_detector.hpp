@@ -0,0 +1,970 @@
+#pragma once
+
+#include <opencv2/core.hpp> // Mat e tipos básicos do OpenCV.
+#include <opencv2/imgproc.hpp> // resize, integral, groupRectangles.
+#include <opencv2/objdetect.hpp> // groupRectangles (em versões antigas).
+#include <algorithm> // std::max, std::min.
+#include <cmath> // std::sqrt.
+#include <cstdint> // Tipos inteiros de tamanho fixo.
+#include <cstring> // memcpy e memcmp do cabeçalho do cascade compilado.
+#include <filesystem> // Data dos arquivos do cascade (XML ou compilado).
+#include <fstream> // Leitura e gravação do cascade compilado.
+#include <iostream> // Mensagens de erro na carga.
+#include <memory> // shared_ptr do bloco do cascade.
+#include <string> // Caminho do XML.
+#include <type_traits> // Tipo dos elementos de cada array na montagem do cascade.
+#include <vector> // Arrays do cascade.
+#include "thread_pool.hpp" // Pool com roubo de tarefas.
+
+#ifndef _WIN32
+#include <fcntl.h> // open do cascade compilado.
+#include <sys/mman.h> // mmap do cascade compilado.
+#include <sys/stat.h> // Tamanho do arquivo.
+#include <unistd.h> // close.
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h> // Intrínsecos SSE2/AVX2 do kernel de avaliação.
+#define HAAR_SIMD_X86 1
+#define HAAR_TARGET_AVX2 __attribute__((target("avx2")))
+#if defined(__SSE2__)
+#define HAAR_TARGET_SSE2 // Já faz parte da arquitetura base (x86-64).
+#else
+#define HAAR_TARGET_SSE2 __attribute__((target("sse2")))
+#endif
+#else
+#define HAAR_SIMD_X86 0
+#endif
+
+/** @brief Versão do laço interno que avalia as janelas. */
+enum class HaarKernel {
+    Scalar, // Uma janela por vez.
+    SSE2, // 4 janelas vizinhas por vez.
+    AVX2 // 8 janelas vizinhas por vez.
+};
+
+inline const char* haarKernelName(HaarKernel kernel) {
+    switch (kernel) {
+    case HaarKernel::AVX2: return "avx2";
+    case HaarKernel::SSE2: return "sse2";
+    default: return "escalar";
+    }
+}
+
+inline bool haarKernelSupported(HaarKernel kernel) {
+#if HAAR_SIMD_X86
+    if (kernel == HaarKernel::AVX2)
+        return __builtin_cpu_supports("avx2");
+    if (kernel == HaarKernel::SSE2)
+        return __builtin_cpu_supports("sse2");
+    return true;
+#else
+    return kernel == HaarKernel::Scalar;
+#endif
+}
+
+/** @brief Melhor kernel que o processador em que o programa está rodando suporta. */
+inline HaarKernel bestHaarKernel() {
+    if (haarKernelSupported(HaarKernel::AVX2))
+        return HaarKernel::AVX2;
+    if (haarKernelSupported(HaarKernel::SSE2))
+        return HaarKernel::SSE2;
+    return HaarKernel::Scalar;
+}
+
+/** @brief Array somente leitura dentro do bloco de memória de um HaarCascade (heap ou arquivo mapeado). */
+template <typename T>
+class CascadeArray {
+public:
+    const T& operator[](size_t i) const {
+        return ptr[i];
+    }
+
+    const T* data() const {
+        return ptr;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+private:
+    friend struct HaarCascade;
+    const T* ptr = nullptr;
+    size_t count = 0;
+};
+
+/**
+ * @brief Cabeçalho do cascade compilado (.bin). Os arrays vêm depois, na ordem dos campos
+ * do HaarCascade, cada um começando num múltiplo de 64 bytes.
+ */
+struct HaarCascadeFileHeader {
+    static const uint32_t currentVersion = 1;
+    static const uint32_t byteOrderMark = 0x01020304; // Lido trocado numa máquina com a outra ordem de bytes.
+    static const int arrayCount = 12;
+
+    char magic[8]; // "HAARBIN".
+    uint32_t version;
+    uint32_t byteOrder;
+    int32_t windowWidth, windowHeight;
+    uint32_t hasTilted;
+    uint32_t stageCount, weakCount;
+    uint32_t reserved;
+    uint64_t fileSize;
+    uint64_t offsets[arrayCount]; // Início de cada array, a partir do começo do arquivo.
+};
+
+/**
+ * @brief Cascade Haar (só "stumps", como os do OpenCV) em estrutura de arrays.
+ *
+ * Cada campo de cada classificador fraco fica num array próprio e contíguo, na
+ * ordem de avaliação, e os até três retângulos de cada feature ficam junto do seu
+ * classificador (índice weak * 3 + k). Lê tanto o formato novo do OpenCV
+ * (haarcascade_frontalface_default.xml) quanto o antigo (hand.xml, com features
+ * inclinadas).
+ *
+ * Os arrays ficam todos num bloco só, no mesmo formato do cascade compilado (.bin,
+ * gerado pelo cascade_compile): do XML o bloco é montado na memória, e um .bin é
+ * mapeado direto do arquivo (mmap) e fica pronto depois de conferir o cabeçalho, sem
+ * interpretar nada. Cópias do HaarCascade dividem o mesmo bloco.
+ */
+struct HaarCascade {
+    cv::Size window; // Tamanho da janela de treino (24x24).
+    bool hasTilted = false; // Alguma feature usa a integral inclinada.
+
+    CascadeArray<float> stageThreshold; // Limiar de cada estágio.
+    CascadeArray<int> stageBegin; // Primeiro classificador fraco do estágio.
+    CascadeArray<int> stageEnd; // Um depois do último classificador fraco do estágio.
+
+    CascadeArray<float> weakThreshold; // Limiar do classificador fraco.
+    CascadeArray<float> leftValue; // Valor somado se feature < limiar.
+    CascadeArray<float> rightValue; // Valor somado caso contrário.
+    CascadeArray<uint8_t> tilted; // Feature inclinada (45 graus).
+
+    CascadeArray<int> rectX, rectY, rectW, rectH; // Retângulos, 3 por classificador fraco.
+    CascadeArray<float> rectWeight; // Peso de cada retângulo (0 quando não existe).
+
+    bool empty() const {
+        return stageThreshold.empty();
+    }
+
+    int weakCount() const {
+        return (int)weakThreshold.size();
+    }
+
+    /** @brief Lê um cascade Haar em XML do OpenCV ou um cascade compilado (.bin). */
+    bool load(const std::string& path) {
+        *this = HaarCascade();
+        if (isCompiled(path))
+            return loadCompiled(path);
+        cv::FileStorage fs;
+        try {
+            if (!fs.open(path, cv::FileStorage::READ))
+                return false;
+        } catch (const cv::Exception&) {
+            return false;
+        }
+        cv::FileNode root = fs.getFirstTopLevelNode();
+        Builder builder;
+        bool ok = root["stageType"].empty() ? builder.loadOldFormat(root) : builder.loadNewFormat(root);
+        if (!ok) {
+            std::cerr << "Cascade nao suportado (so Haar com stumps): " << path << std::endl;
+            return false;
+        }
+        return pack(builder);
+    }
+
+    /**
+     * @brief Usa o compilado ao lado do XML (mesmo nome, extensão .bin) se ele existir e não
+     * for mais velho que o XML; senão lê o XML.
+     */
+    bool loadPreferCompiled(const std::string& xmlPath) {
+        std::error_code error;
+        std::string binPath = compiledPath(xmlPath);
+        auto binTime = std::filesystem::last_write_time(binPath, error);
+        if (!error) {
+            auto xmlTime = std::filesystem::last_write_time(xmlPath, error);
+            if ((error || binTime >= xmlTime) && load(binPath))
+                return true;
+        }
+        return load(xmlPath);
+    }
+
+    /** @brief Caminho do compilado correspondente a um XML (troca a extensão por .bin). */
+    static std::string compiledPath(const std::string& xmlPath) {
+        return std::filesystem::path(xmlPath).replace_extension(".bin").string();
+    }
+
+    /** @brief Grava o cascade no formato compilado. */
+    bool save(const std::string& path) const {
+        if (empty())
+            return false;
+        std::ofstream out(path, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(block.get()), (std::streamsize)blockSize);
+        return (bool)out;
+    }
+
+    /** @brief Tamanho do bloco com os arrays (o mesmo do .bin). */
+    size_t byteSize() const {
+        return blockSize;
+    }
+
+    /** @brief Mesmo conteúdo, byte a byte (o bloco inteiro, cabeçalho incluído). */
+    bool sameData(const HaarCascade& other) const {
+        return blockSize == other.blockSize && (blockSize == 0 || std::memcmp(block.get(), other.block.get(), blockSize) == 0);
+    }
+
+    /** @brief true se os arrays estão no arquivo mapeado, e não numa cópia na memória. */
+    bool isMapped() const {
+        return mapped;
+    }
+
+private:
+    using Header = HaarCascadeFileHeader;
+
+    // Cascade lido do XML, em vetores; pack() copia tudo para um bloco no formato do .bin.
+    struct Builder {
+        static constexpr float thresholdEps = 1e-5f; // O OpenCV afrouxa os limiares dos estágios neste tanto.
+
+        cv::Size window;
+        bool hasTilted = false;
+        std::vector<float> stageThreshold;
+        std::vector<int> stageBegin, stageEnd;
+        std::vector<float> weakThreshold, leftValue, rightValue;
+        std::vector<uint8_t> tilted;
+        std::vector<int> rectX, rectY, rectW, rectH;
+        std::vector<float> rectWeight;
+
+        int weakCount() const {
+            return (int)weakThreshold.size();
+        }
+
+        void addWeak(const cv::FileNode& rects, bool isTilted, float threshold, float left, float right) {
+            weakThreshold.push_back(threshold);
+            leftValue.push_back(left);
+            rightValue.push_back(right);
+            tilted.push_back(isTilted ? 1 : 0);
+            hasTilted = hasTilted || isTilted;
+            int k = 0;
+            for (cv::FileNodeIterator it = rects.begin(); it != rects.end() && k < 3; ++it, k++) {
+                std::vector<float> r; // x y largura altura peso
+                *it >> r;
+                rectX.push_back((int)r[0]);
+                rectY.push_back((int)r[1]);
+                rectW.push_back((int)r[2]);
+                rectH.push_back((int)r[3]);
+                rectWeight.push_back(r[4]);
+            }
+            for (; k < 3; k++) { // Completa com retângulos vazios de peso zero.
+                rectX.push_back(0);
+                rectY.push_back(0);
+                rectW.push_back(0);
+                rectH.push_back(0);
+                rectWeight.push_back(0.f);
+            }
+        }
+
+        // Formato do opencv_traincascade: <cascade><stageType>BOOST</stageType><featureType>HAAR</featureType>...
+        bool loadNewFormat(const cv::FileNode& root) {
+            if ((std::string)root["stageType"] != "BOOST" || (std::string)root["featureType"] != "HAAR")
+                return false;
+            window = cv::Size((int)root["width"], (int)root["height"]);
+            cv::FileNode features = root["features"];
+            std::vector<cv::FileNode> featureNodes;
+            for (cv::FileNodeIterator it = features.begin(); it != features.end(); ++it)
+                featureNodes.push_back(*it);
+
+            cv::FileNode stages = root["stages"];
+            for (cv::FileNodeIterator s = stages.begin(); s != stages.end(); ++s) {
+                stageThreshold.push_back((float)(*s)["stageThreshold"] - thresholdEps);
+                stageBegin.push_back(weakCount());
+                cv::FileNode weaks = (*s)["weakClassifiers"];
+                for (cv::FileNodeIterator w = weaks.begin(); w != weaks.end(); ++w) {
+                    std::vector<float> nodes, leaves; // nodes: esquerda, direita, feature, limiar
+                    (*w)["internalNodes"] >> nodes;
+                    (*w)["leafValues"] >> leaves;
+                    if (nodes.size() != 4 || leaves.size() != 2)
+                        return false; // Árvore com mais de um nó.
+                    int featureIndex = (int)nodes[2];
+                    if (featureIndex < 0 || featureIndex >= (int)featureNodes.size())
+                        return false;
+                    const cv::FileNode& feature = featureNodes[featureIndex];
+                    addWeak(feature["rects"], !feature["tilted"].empty() && (int)feature["tilted"] != 0,
+                            nodes[3], leaves[0], leaves[1]);
+                }
+                stageEnd.push_back(weakCount());
+            }
+            return !stageThreshold.empty();
+        }
+
+        // Formato antigo (opencv-haar-classifier): <size>, <stages><trees>... com as features dentro das árvores.
+        bool loadOldFormat(const cv::FileNode& root) {
+            std::vector<int> size;
+            root["size"] >> size;
+            if (size.size() != 2)
+                return false;
+            window = cv::Size(size[0], size[1]);
+            cv::FileNode stages = root["stages"];
+            for (cv::FileNodeIterator s = stages.begin(); s != stages.end(); ++s) {
+                stageThreshold.push_back((float)(*s)["stage_threshold"] - thresholdEps);
+                stageBegin.push_back(weakCount());
+                cv::FileNode trees = (*s)["trees"];
+                for (cv::FileNodeIterator t = trees.begin(); t != trees.end(); ++t) {
+                    if ((*t).size() != 1)
+                        return false; // Árvore com mais de um nó.
+                    cv::FileNode node = (*t)[0];
+                    if (node["left_val"].empty() || node["right_val"].empty())
+                        return false;
+                    cv::FileNode feature = node["feature"];
+                    addWeak(feature["rects"], (int)feature["tilted"] != 0, (float)node["threshold"],
+                            (float)node["left_val"], (float)node["right_val"]);
+                }
+                stageEnd.push_back(weakCount());
+            }
+            return !stageThreshold.empty();
+        }
+    };
+
+    // Chama f(i, array) para os arrays de c (Builder ou HaarCascade), na ordem do arquivo.
+    template <typename C, typename F>
+    static void forEachArray(C& c, F f) {
+        f(0, c.stageThreshold);
+        f(1, c.stageBegin);
+        f(2, c.stageEnd);
+        f(3, c.weakThreshold);
+        f(4, c.leftValue);
+        f(5, c.rightValue);
+        f(6, c.tilted);
+        f(7, c.rectX);
+        f(8, c.rectY);
+        f(9, c.rectW);
+        f(10, c.rectH);
+        f(11, c.rectWeight);
+    }
+
+    static size_t alignUp(size_t n) {
+        return (n + 63) & ~(size_t)63;
+    }
+
+    // Monta o bloco (cabeçalho e arrays alinhados) a partir dos vetores lidos do XML.
+    bool pack(const Builder& builder) {
+        Header header = {};
+        std::memcpy(header.magic, "HAARBIN", 8);
+        header.version = Header::currentVersion;
+        header.byteOrder = Header::byteOrderMark;
+        header.windowWidth = builder.window.width;
+        header.windowHeight = builder.window.height;
+        header.hasTilted = builder.hasTilted;
+        header.stageCount = (uint32_t)builder.stageThreshold.size();
+        header.weakCount = (uint32_t)builder.weakThreshold.size();
+        size_t offset = alignUp(sizeof(Header));
+        forEachArray(builder, [&](int i, const auto& v) {
+            header.offsets[i] = offset;
+            offset = alignUp(offset + v.size() * sizeof(v[0]));
+        });
+        header.fileSize = offset;
+        uint8_t* memory = static_cast<uint8_t*>(cv::fastMalloc(offset)); // Alinhado pelo OpenCV (64 bytes).
+        std::memset(memory, 0, offset);
+        std::memcpy(memory, &header, sizeof(header));
+        forEachArray(builder, [&](int i, const auto& v) {
+            if (!v.empty())
+                std::memcpy(memory + header.offsets[i], v.data(), v.size() * sizeof(v[0]));
+        });
+        std::shared_ptr<const uint8_t> owned(memory, [](const uint8_t* p) { cv::fastFree(const_cast<uint8_t*>(p)); });
+        return attach(owned, offset, false);
+    }
+
+    static bool isCompiled(const std::string& path) {
+        char magic[8] = {};
+        std::ifstream in(path, std::ios::binary);
+        return in.read(magic, sizeof(magic)) && std::memcmp(magic, "HAARBIN", 8) == 0;
+    }
+
+    // Mapeia o arquivo (no Windows, lê de uma vez) e aponta os arrays para dentro dele.
+    bool loadCompiled(const std::string& path) {
+        std::shared_ptr<const uint8_t> memory;
+        size_t size = 0;
+#ifndef _WIN32
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat info;
+        void* mapping = MAP_FAILED;
+        if (::fstat(fd, &info) == 0 && info.st_size >= (off_t)sizeof(Header)) {
+            size = (size_t)info.st_size;
+            mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd); // O mapeamento continua valendo sem o descritor.
+        if (mapping == MAP_FAILED)
+            return false;
+        memory.reset(static_cast<const uint8_t*>(mapping), [size](const uint8_t* p) { ::munmap(const_cast<uint8_t*>(p), size); });
+        bool isMapping = true;
+#else
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in)
+            return false;
+        size = (size_t)in.tellg();
+        uint8_t* buffer = static_cast<uint8_t*>(cv::fastMalloc(std::max(size, (size_t)1)));
+        memory.reset(buffer, [](const uint8_t* p) { cv::fastFree(const_cast<uint8_t*>(p)); });
+        in.seekg(0);
+        if (!in.read(reinterpret_cast<char*>(buffer), (std::streamsize)size))
+            return false;
+        bool isMapping = false;
+#endif
+        if (!attach(memory, size, isMapping)) {
+            std::cerr << "Cascade compilado invalido ou de outra versao: " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Confere o cabeçalho e os limites do bloco e aponta os arrays para dentro dele.
+    bool attach(const std::shared_ptr<const uint8_t>& memory, size_t size, bool isMapping) {
+        Header header;
+        if (size < sizeof(header))
+            return false;
+        std::memcpy(&header, memory.get(), sizeof(header));
+        if (std::memcmp(header.magic, "HAARBIN", 8) != 0 || header.version != Header::currentVersion
+            || header.byteOrder != Header::byteOrderMark || header.fileSize != size || header.stageCount == 0
+            || header.windowWidth <= 0 || header.windowHeight <= 0)
+            return false;
+        size_t stages = header.stageCount, weaks = header.weakCount;
+        bool ok = true;
+        forEachArray(*this, [&](int i, auto& a) {
+            using T = typename std::remove_const<typename std::remove_pointer<decltype(a.ptr)>::type>::type;
+            size_t count = i < 3 ? stages : i < 7 ? weaks : 3 * weaks;
+            uint64_t offset = header.offsets[i];
+            if (offset % 64 != 0 || offset > size || count > (size - offset) / sizeof(T)) {
+                ok = false;
+                return;
+            }
+            a.ptr = reinterpret_cast<const T*>(memory.get() + offset);
+            a.count = count;
+        });
+        window = cv::Size(header.windowWidth, header.windowHeight);
+        ok = ok && validate();
+        if (!ok) {
+            *this = HaarCascade();
+            return false;
+        }
+        hasTilted = header.hasTilted != 0;
+        block = memory;
+        blockSize = size;
+        mapped = isMapping;
+        return true;
+    }
+
+    // Índices dos estágios e retângulos dentro da janela: um arquivo corrompido não faz o detector ler fora da integral.
+    bool validate() const {
+        for (size_t s = 0; s < stageThreshold.size(); s++)
+            if (stageBegin[s] < 0 || stageBegin[s] > stageEnd[s] || stageEnd[s] > weakCount())
+                return false;
+        for (size_t i = 0; i < rectX.size(); i++) {
+            int x = rectX[i], y = rectY[i], w = rectW[i], h = rectH[i];
+            if (x < 0 || y < 0 || w < 0 || h < 0)
+                return false;
+            bool inside = tilted[i / 3] ? x - h >= 0 && x + w <= window.width && y + w + h <= window.height
+                                        : x + w <= window.width && y + h <= window.height;
+            if (!inside)
+                return false;
+        }
+        return true;
+    }
+
+    std::shared_ptr<const uint8_t> block; // Cabeçalho e arrays.
+    size_t blockSize = 0;
+    bool mapped = false;
+};
+
+/**
+ * @brief Detector multi-escala próprio para cascades Haar, paralelo e com pirâmide de integrais.
+ *
+ * Mesmo algoritmo do CascadeClassifier com CASCADE_SCALE_IMAGE: a imagem é reduzida
+ * por scaleFactor a cada nível, a janela de 24x24 percorre cada nível (passo 2 nos
+ * níveis até 2x, 1 nos outros), as janelas com pouca variação são descartadas e os
+ * candidatos são agrupados com groupRectangles. Por isso o resultado bate com o do
+ * OpenCV, a menos de arredondamentos.
+ *
+ * As integrais de todos os níveis são montadas uma vez por frame com a mesma largura
+ * de linha, de modo que os deslocamentos dos retângulos no buffer são calculados uma
+ * vez só e valem para todos os níveis. Os níveis são montados em paralelo e depois
+ * as faixas de linhas de todos os níveis viram tarefas no ThreadPool.
+ *
+ * Dentro de cada faixa, cada classificador fraco é avaliado em 8 (AVX2) ou 4 (SSE2)
+ * janelas vizinhas de uma vez: leitura das integrais, soma ponderada dos retângulos,
+ * comparação com o limiar e soma do estágio são feitas nos vetores, e o bloco para
+ * quando todas as janelas são rejeitadas. O kernel é escolhido em tempo de execução
+ * conforme o processador, e o resultado é o mesmo do caminho escalar.
+ */
+class HaarDetector {
+public:
+    /**
+     * @param pool pool usado para dividir o trabalho (nullptr = só a thread que chama).
+     */
+    explicit HaarDetector(ThreadPool* pool = &ThreadPool::shared()) : pool(pool) {}
+
+    /** @brief Lê o cascade em XML ou compilado (.bin). */
+    bool load(const std::string& path) {
+        levels.clear();
+        offsetStep = 0;
+        return data.load(path);
+    }
+
+    /** @brief Como load(), mas usa o .bin ao lado do XML se ele estiver em dia (HaarCascade::loadPreferCompiled). */
+    bool loadPreferCompiled(const std::string& xmlPath) {
+        levels.clear();
+        offsetStep = 0;
+        return data.loadPreferCompiled(xmlPath);
+    }
+
+    bool empty() const {
+        return data.empty();
+    }
+
+    cv::Size getOriginalWindowSize() const {
+        return data.window;
+    }
+
+    const HaarCascade& cascade() const {
+        return data;
+    }
+
+    void setThreadPool(ThreadPool* newPool) {
+        pool = newPool;
+    }
+
+    /** @brief Troca o kernel de avaliação; devolve false se o processador não suporta. */
+    bool setKernel(HaarKernel kernel) {
+        if (!haarKernelSupported(kernel))
+            return false;
+        kernelType = kernel;
+        return true;
+    }
+
+    HaarKernel kernel() const {
+        return kernelType;
+    }
+
+    /** @brief Usa só os primeiros stages estágios do cascade (0 = todos). Serve para medir cada estágio. */
+    void setStageLimit(int stages) {
+        stageLimit = std::max(stages, 0);
+    }
+
+    /** @brief Quantas janelas a última chamada de detectMultiScale avaliou. */
+    long windowCount() const {
+        return windows;
+    }
+
+    /**
+     * @brief Mesma interface do CascadeClassifier::detectMultiScale. flags é ignorado:
+     * o detector sempre trabalha reduzindo a imagem (CASCADE_SCALE_IMAGE).
+     */
+    void detectMultiScale(const cv::Mat& gray, std::vector<cv::Rect>& objects, double scaleFactor = 1.1,
+                          int minNeighbors = 3, int flags = 0, cv::Size minSize = cv::Size(),
+                          cv::Size maxSize = cv::Size()) {
+        (void)flags;
+        objects.clear();
+        if (data.empty() || gray.empty())
+            return;
+        CV_Assert(gray.type() == CV_8UC1 && scaleFactor > 1.0);
+        if (maxSize.width <= 0 || maxSize.height <= 0)
+            maxSize = gray.size();
+
+        buildPyramid(gray, scaleFactor, minSize, maxSize);
+        scanLevels();
+
+        for (const std::vector<cv::Rect>& found : taskResults)
+            objects.insert(objects.end(), found.begin(), found.end());
+        if (minNeighbors > 0)
+            cv::groupRectangles(objects, minNeighbors, 0.2);
+    }
+
+protected:
+    struct Level {
+        double factor = 1; // Quanto o nível foi reduzido em relação ao quadro.
+        cv::Size size; // Tamanho da imagem reduzida.
+        cv::Size windowSize; // Tamanho da janela em coordenadas do quadro.
+        int step = 2; // Passo da janela em x e y.
+        cv::Mat image; // Imagem reduzida.
+        cv::Mat sum, sqsum, tiltedSum; // Integrais, todas com a mesma largura de linha.
+    };
+
+    struct Task {
+        int level; // Nível da pirâmide.
+        int y0, y1; // Faixa de linhas (posições do canto da janela).
+    };
+
+    void buildPyramid(const cv::Mat& gray, double scaleFactor, cv::Size minSize, cv::Size maxSize) {
+        std::vector<double> factors;
+        for (double factor = 1;; factor *= scaleFactor) {
+            cv::Size windowSize(cvRound(data.window.width * factor), cvRound(data.window.height * factor));
+            cv::Size scaled(cvRound(gray.cols / factor), cvRound(gray.rows / factor));
+            if (scaled.width < data.window.width || scaled.height < data.window.height)
+                break;
+            if (windowSize.width > maxSize.width || windowSize.height > maxSize.height)
+                break;
+            if (windowSize.width < minSize.width || windowSize.height < minSize.height)
+                continue;
+            factors.push_back(factor);
+        }
+
+        // Cada nível ganha a sua faixa de linhas num buffer comum, com a largura do nível sem redução.
+        levels.resize(factors.size());
+        int rows = 0;
+        for (size_t i = 0; i < factors.size(); i++) {
+            Level& level = levels[i];
+            level.factor = factors[i];
+            level.size = cv::Size(cvRound(gray.cols / factors[i]), cvRound(gray.rows / factors[i]));
+            level.windowSize = cv::Size(cvRound(data.window.width * factors[i]), cvRound(data.window.height * factors[i]));
+            level.step = factors[i] > 2 ? 1 : 2;
+            rows += level.size.height + 1;
+        }
+        int step = gray.cols + 1;
+        rows++; // Linha extra: com passo 2 os kernels SIMD leem um valor além da última janela.
+        if (sumBuffer.rows < rows || sumBuffer.cols != step) {
+            sumBuffer.create(std::max(rows, sumBuffer.rows), step, CV_32SC1);
+            sqsumBuffer.create(sumBuffer.rows, step, CV_64FC1);
+        }
+        if (data.hasTilted && tiltedBuffer.size() != sumBuffer.size()) // O cascade pode ter mudado desde a última alocação.
+            tiltedBuffer.create(sumBuffer.rows, step, CV_32SC1);
+        int row = 0;
+        for (Level& level : levels) {
+            cv::Rect area(0, row, level.size.width + 1, level.size.height + 1);
+            level.sum = sumBuffer(area);
+            level.sqsum = sqsumBuffer(area);
+            if (data.hasTilted)
+                level.tiltedSum = tiltedBuffer(area);
+            row += area.height;
+        }
+        computeOffsets(step);
+
+        auto build = [&](int i) {
+            Level& level = levels[i];
+            if (level.factor == 1)
+                level.image = gray;
+            else
+                cv::resize(gray, level.image, level.size, 0, 0, cv::INTER_LINEAR);
+            // As saídas já têm o tamanho certo, então integral() escreve direto no buffer comum.
+            if (data.hasTilted)
+                cv::integral(level.image, level.sum, level.sqsum, level.tiltedSum, CV_32S, CV_64F);
+            else
+                cv::integral(level.image, level.sum, level.sqsum, CV_32S, CV_64F);
+        };
+        if (pool)
+            pool->parallelFor(0, (int)levels.size(), build);
+        else
+            for (int i = 0; i < (int)levels.size(); i++)
+                build(i);
+    }
+
+    // Deslocamentos dos cantos de cada retângulo dentro da integral, para a largura de linha dada.
+    void computeOffsets(int step) {
+        if (step == offsetStep)
+            return;
+        offsetStep = step;
+        int n = (int)data.rectX.size();
+        for (int c = 0; c < 4; c++)
+            offsets[c].assign(n, 0);
+        for (int i = 0; i < n; i++) {
+            int x = data.rectX[i], y = data.rectY[i], w = data.rectW[i], h = data.rectH[i];
+            if (data.tilted[i / 3]) { // Cantos do retângulo inclinado (como CV_TILTED_OFFSETS).
+                offsets[0][i] = y * step + x;
+                offsets[1][i] = (y + h) * step + x - h;
+                offsets[2][i] = (y + w) * step + x + w;
+                offsets[3][i] = (y + w + h) * step + x + w - h;
+            } else {
+                offsets[0][i] = y * step + x;
+                offsets[1][i] = y * step + x + w;
+                offsets[2][i] = (y + h) * step + x;
+                offsets[3][i] = (y + h) * step + x + w;
+            }
+        }
+        // Retângulo de normalização: a janela sem a borda de 1 pixel.
+        int w = data.window.width - 2, h = data.window.height - 2;
+        normOffsets[0] = step + 1;
+        normOffsets[1] = step + 1 + w;
+        normOffsets[2] = (h + 1) * step + 1;
+        normOffsets[3] = (h + 1) * step + 1 + w;
+        normArea = (double)w * h;
+    }
+
+    void scanLevels() {
+        const int band = 8; // Linhas de janelas por tarefa.
+        tasks.clear();
+        windows = 0;
+        for (int i = 0; i < (int)levels.size(); i++) {
+            int rows = levels[i].size.height - data.window.height + 1;
+            int cols = levels[i].size.width - data.window.width + 1;
+            windows += (long)((rows + levels[i].step - 1) / levels[i].step) * ((cols + levels[i].step - 1) / levels[i].step);
+            for (int y = 0; y < rows; y += band * levels[i].step)
+                tasks.push_back(Task{ i, y, std::min(rows, y + band * levels[i].step) });
+        }
+        taskResults.resize(tasks.size());
+        auto scan = [&](int t) {
+            taskResults[t].clear();
+            scanTask(tasks[t], taskResults[t]);
+        };
+        if (pool)
+            pool->parallelFor(0, (int)tasks.size(), scan);
+        else
+            for (int t = 0; t < (int)tasks.size(); t++)
+                scan(t);
+    }
+
+    void scanTask(const Task& task, std::vector<cv::Rect>& found) const {
+        const Level& level = levels[task.level];
+        int cols = level.size.width - data.window.width + 1;
+        int step = (int)(level.sum.step / sizeof(int));
+        int stride = level.step;
+        for (int y = task.y0; y < task.y1; y += stride) {
+            int x = 0;
+#if HAAR_SIMD_X86
+            // Blocos de 8 (AVX2) ou 4 (SSE2) janelas vizinhas; o resto da linha vai pelo caminho escalar.
+            if (kernelType == HaarKernel::AVX2) {
+                for (; x + 7 * stride < cols; x += 8 * stride)
+                    addWindows(found, level, x, y, stride == 1 ? evaluateAvx2<1>(level, y * step + x)
+                                                               : evaluateAvx2<2>(level, y * step + x));
+            } else if (kernelType == HaarKernel::SSE2) {
+                for (; x + 3 * stride < cols; x += 4 * stride)
+                    addWindows(found, level, x, y, stride == 1 ? evaluateSse2<1>(level, y * step + x)
+                                                               : evaluateSse2<2>(level, y * step + x));
+            }
+#endif
+            for (; x < cols; x += stride) {
+                if (evaluateWindow(level, y * step + x))
+                    addWindows(found, level, x, y, 1);
+            }
+        }
+    }
+
+    // Converte as janelas aceitas (bit k = janela x + k * passo) para coordenadas do quadro.
+    void addWindows(std::vector<cv::Rect>& found, const Level& level, int x, int y, int accepted) const {
+        for (int k = 0; accepted; k++, accepted >>= 1) {
+            if (accepted & 1)
+                found.push_back(cv::Rect(cvRound((x + k * level.step) * level.factor), cvRound(y * level.factor),
+                                         level.windowSize.width, level.windowSize.height));
+        }
+    }
+
+    // Fator de normalização da janela (1 / (área * desvio padrão)); 0 se a janela for lisa demais.
+    float normFactor(const Level& level, int p) const {
+        const int* sum = level.sum.ptr<int>() + p;
+        const double* sqsum = level.sqsum.ptr<double>() + p;
+        int valsum = sum[normOffsets[0]] - sum[normOffsets[1]] - sum[normOffsets[2]] + sum[normOffsets[3]];
+        double valsqsum = sqsum[normOffsets[0]] - sqsum[normOffsets[1]] - sqsum[normOffsets[2]] + sqsum[normOffsets[3]];
+        double nf = normArea * valsqsum - (double)valsum * valsum;
+        if (nf <= 0)
+            return 0;
+        nf = std::sqrt(nf);
+        if (normArea / nf >= 0.1) // Mesmo corte do OpenCV: desvio padrão abaixo de 10.
+            return 0;
+        return (float)(1.0 / nf);
+    }
+
+    int stageCount() const {
+        int stages = (int)data.stageThreshold.size();
+        return stageLimit > 0 ? std::min(stageLimit, stages) : stages;
+    }
+
+    // Passa a janela (canto no deslocamento p da integral) por todos os estágios.
+    bool evaluateWindow(const Level& level, int p) const {
+        float norm = normFactor(level, p);
+        return norm != 0 && passesStages(level, p, norm, 0);
+    }
+
+    // Estágios a partir de firstStage, uma janela por vez.
+    bool passesStages(const Level& level, int p, float norm, int firstStage) const {
+        const int* sum = level.sum.ptr<int>() + p;
+        const int* tiltedSum = data.hasTilted ? level.tiltedSum.ptr<int>() + p : sum;
+        const int* o0 = offsets[0].data();
+        const int* o1 = offsets[1].data();
+        const int* o2 = offsets[2].data();
+        const int* o3 = offsets[3].data();
+        const float* weight = data.rectWeight.data();
+        for (int s = firstStage, stages = stageCount(); s < stages; s++) {
+            float stageSum = 0;
+            for (int w = data.stageBegin[s]; w < data.stageEnd[s]; w++) {
+                const int* base = data.tilted[w] ? tiltedSum : sum;
+                int r = w * 3;
+                float value = weight[r] * (base[o0[r]] - base[o1[r]] - base[o2[r]] + base[o3[r]])
+                            + weight[r + 1] * (base[o0[r + 1]] - base[o1[r + 1]] - base[o2[r + 1]] + base[o3[r + 1]]);
+                if (weight[r + 2] != 0.f)
+                    value += weight[r + 2] * (base[o0[r + 2]] - base[o1[r + 2]] - base[o2[r + 2]] + base[o3[r + 2]]);
+                stageSum += value * norm < data.weakThreshold[w] ? data.leftValue[w] : data.rightValue[w];
+            }
+            if (stageSum < data.stageThreshold[s])
+                return false;
+        }
+        return true;
+    }
+
+    // Calcula a normalização de count janelas a partir de p; devolve a máscara das que não são lisas.
+    int normFactors(const Level& level, int p, int stride, int count, float* norms) const {
+        int alive = 0;
+        for (int k = 0; k < count; k++) {
+            norms[k] = normFactor(level, p + k * stride);
+            if (norms[k] != 0)
+                alive |= 1 << k;
+        }
+        return alive;
+    }
+
+    // Termina, uma a uma, as janelas que ainda estão vivas quando sobram poucas no bloco.
+    int finishScalar(const Level& level, int p, int stride, const float* norms, int alive, int stage) const {
+        for (int k = 0; (alive >> k) != 0; k++) {
+            if ((alive >> k & 1) && !passesStages(level, p + k * stride, norms[k], stage))
+                alive &= ~(1 << k);
+        }
+        return alive;
+    }
+
+#if HAAR_SIMD_X86
+    // Lê ptr[0..15] e fica com os de índice par (mais rápido que o gather do AVX2 para passo 2).
+    HAAR_TARGET_AVX2 static __m256i evenLanesAvx2(const int* ptr) {
+        __m256 lo = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i*)ptr));
+        __m256 hi = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i*)(ptr + 8)));
+        __m256 even = _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)); // 0 2 8 10 | 4 6 12 14
+        return _mm256_permute4x64_epi64(_mm256_castps_si256(even), _MM_SHUFFLE(3, 1, 2, 0));
+    }
+
+    // Soma de um retângulo em 8 janelas vizinhas.
+    template <int Stride>
+    HAAR_TARGET_AVX2 static __m256i rectSumAvx2(const int* base, int o0, int o1, int o2, int o3) {
+        __m256i a, b, c, d;
+        if (Stride == 1) {
+            a = _mm256_loadu_si256((const __m256i*)(base + o0));
+            b = _mm256_loadu_si256((const __m256i*)(base + o1));
+            c = _mm256_loadu_si256((const __m256i*)(base + o2));
+            d = _mm256_loadu_si256((const __m256i*)(base + o3));
+        } else {
+            a = evenLanesAvx2(base + o0);
+            b = evenLanesAvx2(base + o1);
+            c = evenLanesAvx2(base + o2);
+            d = evenLanesAvx2(base + o3);
+        }
+        return _mm256_add_epi32(_mm256_sub_epi32(_mm256_sub_epi32(a, b), c), d);
+    }
+
+    // Avalia 8 janelas vizinhas (a partir de p, com o passo do nível) ao mesmo tempo; devolve a máscara das aceitas.
+    template <int Stride>
+    HAAR_TARGET_AVX2 int evaluateAvx2(const Level& level, int p) const {
+        alignas(32) float norms[8];
+        int alive = normFactors(level, p, Stride, 8, norms);
+        if (!alive)
+            return 0;
+        const int* sum = level.sum.ptr<int>() + p;
+        const int* tiltedSum = data.hasTilted ? level.tiltedSum.ptr<int>() + p : sum;
+        const int* o0 = offsets[0].data();
+        const int* o1 = offsets[1].data();
+        const int* o2 = offsets[2].data();
+        const int* o3 = offsets[3].data();
+        const float* weight = data.rectWeight.data();
+        const __m256 norm = _mm256_load_ps(norms);
+        for (int s = 0, stages = stageCount(); s < stages; s++) {
+            if (__builtin_popcount(alive) <= 2) // Não compensa mais avaliar 8 janelas para aproveitar 2.
+                return finishScalar(level, p, Stride, norms, alive, s);
+            __m256 stageSum = _mm256_setzero_ps();
+            for (int w = data.stageBegin[s]; w < data.stageEnd[s]; w++) {
+                const int* base = data.tilted[w] ? tiltedSum : sum;
+                int r = w * 3;
+                __m256 value = _mm256_mul_ps(_mm256_set1_ps(weight[r]),
+                    _mm256_cvtepi32_ps(rectSumAvx2<Stride>(base, o0[r], o1[r], o2[r], o3[r])));
+                value = _mm256_add_ps(value, _mm256_mul_ps(_mm256_set1_ps(weight[r + 1]),
+                    _mm256_cvtepi32_ps(rectSumAvx2<Stride>(base, o0[r + 1], o1[r + 1], o2[r + 1], o3[r + 1]))));
+                if (weight[r + 2] != 0.f)
+                    value = _mm256_add_ps(value, _mm256_mul_ps(_mm256_set1_ps(weight[r + 2]),
+                        _mm256_cvtepi32_ps(rectSumAvx2<Stride>(base, o0[r + 2], o1[r + 2], o2[r + 2], o3[r + 2]))));
+                __m256 left = _mm256_cmp_ps(_mm256_mul_ps(value, norm), _mm256_set1_ps(data.weakThreshold[w]), _CMP_LT_OQ);
+                stageSum = _mm256_add_ps(stageSum, _mm256_blendv_ps(_mm256_set1_ps(data.rightValue[w]),
+                                                                    _mm256_set1_ps(data.leftValue[w]), left));
+            }
+            alive &= ~_mm256_movemask_ps(_mm256_cmp_ps(stageSum, _mm256_set1_ps(data.stageThreshold[s]), _CMP_LT_OQ));
+            if (!alive)
+                return 0;
+        }
+        return alive;
+    }
+
+    // Lê ptr[0..7] e fica com os de índice par. ptr[7] não é usado, mas é lido: a linha extra no fim do buffer garante que existe.
+    HAAR_TARGET_SSE2 static __m128i evenLanesSse2(const int* ptr) {
+        __m128 lo = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)ptr));
+        __m128 hi = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(ptr + 4)));
+        return _mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));
+    }
+
+    template <int Stride>
+    HAAR_TARGET_SSE2 static __m128i rectSumSse2(const int* base, int o0, int o1, int o2, int o3) {
+        __m128i a, b, c, d;
+        if (Stride == 1) {
+            a = _mm_loadu_si128((const __m128i*)(base + o0));
+            b = _mm_loadu_si128((const __m128i*)(base + o1));
+            c = _mm_loadu_si128((const __m128i*)(base + o2));
+            d = _mm_loadu_si128((const __m128i*)(base + o3));
+        } else { // SSE2 não tem gather: lê 8 valores seguidos e fica com os de índice par.
+            a = evenLanesSse2(base + o0);
+            b = evenLanesSse2(base + o1);
+            c = evenLanesSse2(base + o2);
+            d = evenLanesSse2(base + o3);
+        }
+        return _mm_add_epi32(_mm_sub_epi32(_mm_sub_epi32(a, b), c), d);
+    }
+
+    // Mesmo que evaluateAvx2, com 4 janelas por vez.
+    template <int Stride>
+    HAAR_TARGET_SSE2 int evaluateSse2(const Level& level, int p) const {
+        alignas(16) float norms[4];
+        int alive = normFactors(level, p, Stride, 4, norms);
+        if (!alive)
+            return 0;
+        const int* sum = level.sum.ptr<int>() + p;
+        const int* tiltedSum = data.hasTilted ? level.tiltedSum.ptr<int>() + p : sum;
+        const int* o0 = offsets[0].data();
+        const int* o1 = offsets[1].data();
+        const int* o2 = offsets[2].data();
+        const int* o3 = offsets[3].data();
+        const float* weight = data.rectWeight.data();
+        const __m128 norm = _mm_load_ps(norms);
+        for (int s = 0, stages = stageCount(); s < stages; s++) {
+            if (__builtin_popcount(alive) <= 1)
+                return finishScalar(level, p, Stride, norms, alive, s);
+            __m128 stageSum = _mm_setzero_ps();
+            for (int w = data.stageBegin[s]; w < data.stageEnd[s]; w++) {
+                const int* base = data.tilted[w] ? tiltedSum : sum;
+                int r = w * 3;
+                __m128 value = _mm_mul_ps(_mm_set1_ps(weight[r]),
+                    _mm_cvtepi32_ps(rectSumSse2<Stride>(base, o0[r], o1[r], o2[r], o3[r])));
+                value = _mm_add_ps(value, _mm_mul_ps(_mm_set1_ps(weight[r + 1]),
+                    _mm_cvtepi32_ps(rectSumSse2<Stride>(base, o0[r + 1], o1[r + 1], o2[r + 1], o3[r + 1]))));
+                if (weight[r + 2] != 0.f)
+                    value = _mm_add_ps(value, _mm_mul_ps(_mm_set1_ps(weight[r + 2]),
+                        _mm_cvtepi32_ps(rectSumSse2<Stride>(base, o0[r + 2], o1[r + 2], o2[r + 2], o3[r + 2]))));
+                __m128 left = _mm_cmplt_ps(_mm_mul_ps(value, norm), _mm_set1_ps(data.weakThreshold[w]));
+                stageSum = _mm_add_ps(stageSum, _mm_or_ps(_mm_and_ps(left, _mm_set1_ps(data.leftValue[w])),
+                                                          _mm_andnot_ps(left, _mm_set1_ps(data.rightValue[w]))));
+            }
+            alive &= ~_mm_movemask_ps(_mm_cmplt_ps(stageSum, _mm_set1_ps(data.stageThreshold[s])));
+            if (!alive)
+                return 0;
+        }
+        return alive;
+    }
+#endif
+
+    HaarCascade data;
+    ThreadPool* pool;
+    std::vector<Level> levels;
+    std::vector<Task> tasks;
+    std::vector<std::vector<cv::Rect>> taskResults; // Candidatos de cada tarefa (reaproveitados entre frames).
+    cv::Mat sumBuffer, sqsumBuffer, tiltedBuffer; // Buffers comuns das integrais de todos os níveis.
+    std::vector<int> offsets[4]; // Cantos de cada retângulo (índice weak * 3 + k).
+    int normOffsets[4] = { 0, 0, 0, 0 }; // Cantos do retângulo de normalização.
+    double normArea = 0;
+    int offsetStep = 0; // Largura de linha usada em offsets.
+    HaarKernel kernelType = bestHaarKernel();
+    int stageLimit = 0; // Só os primeiros estágios (0 = todos); usado pelo benchmark.
+    long windows = 0;
+};
@@ -0,0 +1,254 @@
+#pragma once
+
+#include <opencv2/core.hpp> // Mat, Point, Scalar.
+#include <opencv2/imgproc.hpp> // putText e rectangle do overlay.
+#include <algorithm> // std::sort, std::nth_element.
+#include <atomic> // Índices e campos das filas de eventos.
+#include <chrono> // steady_clock.
+#include <cstdint> // int64_t.
+#include <cstdio> // snprintf.
+#include <fstream> // Exportação do trace.
+#include <memory> // unique_ptr das filas.
+#include <mutex> // Registro das threads.
+#include <string> // Nomes das etapas e das threads.
+#include <vector> // Eventos e estatísticas.
+
+/**
+ * @brief Medição de tempo por etapa do frame, com custo quase zero e removível na compilação.
+ *
+ * PROFILE_SCOPE("deteccao") mede o bloco em que aparece; PROFILE_RECORD(nome, início, fim)
+ * grava um intervalo medido por fora (por exemplo, da captura até a tela). Cada thread grava os seus
+ * eventos (etapa, início, fim) numa fila circular própria, sem trava: só ela escreve,
+ * e quem lê (o overlay ou a exportação) confere o índice depois de copiar para
+ * descartar o que foi sobrescrito no meio da leitura.
+ *
+ * Com -DPROFILER_DISABLED as macros viram nada e nenhuma medição é feita; chamadas diretas
+ * à classe (como drawOverlay) ficam sob #ifndef PROFILER_DISABLED em quem as faz.
+ *
+ * Os nomes passados às macros precisam ser literais (ou viver até o fim do programa),
+ * pois só o ponteiro é guardado.
+ */
+class Profiler {
+public:
+    /** @brief Percentis de uma etapa, em milissegundos. */
+    struct StageStats {
+        std::string name;
+        size_t count = 0;
+        double p50 = 0, p95 = 0, p99 = 0, max = 0;
+    };
+
+    static Profiler& instance() {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    /** @brief Tempo atual em nanossegundos (steady_clock). */
+    static int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /** @brief Dá nome à thread que chama (aparece no trace). */
+    void setThreadName(const char* name) {
+        ThreadLog& log = threadLog();
+        std::lock_guard<std::mutex> lock(registryMutex);
+        log.name = name;
+    }
+
+    /** @brief Grava um evento na fila da thread que chama. */
+    void record(const char* name, int64_t start, int64_t end) {
+        ThreadLog& log = threadLog();
+        uint64_t index = log.head.load(std::memory_order_relaxed);
+        Event& event = log.events[index % capacity];
+        event.name.store(name, std::memory_order_relaxed);
+        event.start.store(start, std::memory_order_relaxed);
+        event.end.store(end, std::memory_order_relaxed);
+        log.head.store(index + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Percentis de cada etapa nos eventos que terminaram nos últimos windowMs
+     * milissegundos (0 = tudo o que ainda está nas filas).
+     */
+    std::vector<StageStats> stats(double windowMs = 0) const {
+        std::vector<Snapshot> events = snapshot();
+        int64_t since = windowMs > 0 ? now() - (int64_t)(windowMs * 1e6) : INT64_MIN;
+        std::vector<StageStats> result;
+        std::vector<std::vector<double>> durations;
+        for (const Snapshot& e : events) {
+            if (e.end < since)
+                continue;
+            size_t i = 0;
+            while (i < result.size() && result[i].name != e.name)
+                i++;
+            if (i == result.size()) {
+                result.emplace_back();
+                result.back().name = e.name;
+                durations.emplace_back();
+            }
+            durations[i].push_back((e.end - e.start) / 1e6);
+        }
+        for (size_t i = 0; i < result.size(); i++) {
+            std::vector<double>& d = durations[i];
+            std::sort(d.begin(), d.end());
+            result[i].count = d.size();
+            result[i].p50 = percentile(d, 0.50);
+            result[i].p95 = percentile(d, 0.95);
+            result[i].p99 = percentile(d, 0.99);
+            result[i].max = d.back();
+        }
+        return result;
+    }
+
+    /**
+     * @brief Desenha uma tabela com p50/p95/p99 de cada etapa (último segundo) no canto do quadro.
+     * @return a região do quadro que foi alterada.
+     */
+    cv::Rect drawOverlay(cv::Mat& frame, cv::Point origin = cv::Point(10, 60), double windowMs = 1000) const {
+        std::vector<StageStats> stages = stats(windowMs);
+        const int lineHeight = 18;
+        cv::Rect box = cv::Rect(origin.x, origin.y, 330, lineHeight * ((int)stages.size() + 1) + 8)
+                     & cv::Rect(0, 0, frame.cols, frame.rows);
+        if (box.area() == 0)
+            return box;
+        cv::Mat area = frame(box);
+        area.convertTo(area, -1, 0.35); // Escurece o fundo da tabela para o texto ficar legível.
+        char line[96];
+        std::snprintf(line, sizeof(line), "%-12s %7s %7s %7s", "etapa (ms)", "p50", "p95", "p99");
+        int y = origin.y + lineHeight;
+        cv::putText(frame, line, cv::Point(origin.x + 5, y), cv::FONT_HERSHEY_PLAIN, 1.0, cv::Scalar(0, 255, 255));
+        for (const StageStats& s : stages) {
+            y += lineHeight;
+            std::snprintf(line, sizeof(line), "%-12.12s %7.2f %7.2f %7.2f", s.name.c_str(), s.p50, s.p95, s.p99);
+            cv::putText(frame, line, cv::Point(origin.x + 5, y), cv::FONT_HERSHEY_PLAIN, 1.0, cv::Scalar(255, 255, 255));
+        }
+        return box;
+    }
+
+    /** @brief Escreve os eventos das filas no formato de trace do Chrome (chrome://tracing, Perfetto). */
+    bool exportChromeTrace(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out)
+            return false;
+        std::vector<Snapshot> events = snapshot();
+        int64_t origin = INT64_MAX;
+        for (const Snapshot& e : events)
+            origin = std::min(origin, e.start);
+        out << "{\"traceEvents\":[\n";
+        bool first = true;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            for (size_t t = 0; t < logs.size(); t++) {
+                out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t
+                    << ",\"args\":{\"name\":\"" << (logs[t]->name ? logs[t]->name : "thread") << "\"}}";
+                first = false;
+            }
+        }
+        char line[256];
+        for (const Snapshot& e : events) {
+            std::snprintf(line, sizeof(line), "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                          e.name, e.thread, (e.start - origin) / 1e3, (e.end - e.start) / 1e3);
+            out << (first ? "" : ",\n") << line;
+            first = false;
+        }
+        out << "\n]}\n";
+        return (bool)out;
+    }
+
+    /** @brief Mede do construtor ao destrutor. Use pela macro PROFILE_SCOPE. */
+    class Scope {
+    public:
+        explicit Scope(const char* name) : name(name), start(now()) {}
+        ~Scope() {
+            Profiler::instance().record(name, start, now());
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* name;
+        int64_t start;
+    };
+
+private:
+    static constexpr size_t capacity = 4096; // Eventos guardados por thread.
+
+    struct Event {
+        std::atomic<const char*> name{nullptr};
+        std::atomic<int64_t> start{0};
+        std::atomic<int64_t> end{0};
+    };
+
+    struct ThreadLog {
+        Event events[capacity];
+        std::atomic<uint64_t> head{0}; // Total de eventos já gravados.
+        const char* name = nullptr;
+    };
+
+    struct Snapshot {
+        const char* name;
+        int64_t start, end;
+        int thread;
+    };
+
+    Profiler() {}
+
+    // Fila da thread atual, criada e registrada no primeiro uso. As filas vivem até o fim do
+    // programa, então os eventos de threads que já terminaram continuam no trace.
+    ThreadLog& threadLog() {
+        thread_local ThreadLog* log = nullptr;
+        if (!log) {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            logs.emplace_back(new ThreadLog);
+            log = logs.back().get();
+        }
+        return *log;
+    }
+
+    // Copia os eventos de todas as filas, descartando os que foram sobrescritos durante a cópia.
+    std::vector<Snapshot> snapshot() const {
+        std::vector<Snapshot> events;
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (size_t t = 0; t < logs.size(); t++) {
+            const ThreadLog& log = *logs[t];
+            uint64_t head = log.head.load(std::memory_order_acquire);
+            uint64_t first = head > capacity ? head - capacity : 0;
+            size_t begin = events.size();
+            for (uint64_t i = first; i < head; i++) {
+                const Event& e = log.events[i % capacity];
+                events.push_back(Snapshot{ e.name.load(std::memory_order_relaxed), e.start.load(std::memory_order_relaxed),
+                                           e.end.load(std::memory_order_relaxed), (int)t });
+            }
+            // O que a thread escreveu enquanto copiávamos (e o evento que ela pode estar escrevendo
+            // agora, de índice after) pode ter passado por cima do começo da cópia.
+            uint64_t after = log.head.load(std::memory_order_acquire);
+            uint64_t valid = after + 1 > capacity ? after + 1 - capacity : 0;
+            if (valid > first)
+                events.erase(events.begin() + begin, events.begin() + begin + (size_t)std::min(valid - first, head - first));
+        }
+        return events;
+    }
+
+    static double percentile(const std::vector<double>& sorted, double q) {
+        if (sorted.empty())
+            return 0;
+        size_t i = (size_t)(q * (sorted.size() - 1) + 0.5);
+        return sorted[std::min(i, sorted.size() - 1)];
+    }
+
+    mutable std::mutex registryMutex;
+    std::vector<std::unique_ptr<ThreadLog>> logs;
+};
+
+#define PROFILER_CONCAT_(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_(a, b)
+
+#ifndef PROFILER_DISABLED
+#define PROFILE_SCOPE(name) Profiler::Scope PROFILER_CONCAT(profileScope_, __LINE__)(name)
+#define PROFILE_THREAD(name) Profiler::instance().setThreadName(name)
+#define PROFILE_RECORD(name, start, end) Profiler::instance().record(name, start, end)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_THREAD(name) ((void)0)
+#define PROFILE_RECORD(name, start, end) ((void)0)
+#endif
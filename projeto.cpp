@@ -5,39 +5,23 @@
 #include <vector> // Inclui a biblioteca para usar vetores dinâmicos.
 #include <chrono> // Inclui suporte para manipulação de tempo.
 #include <cstdlib> // Inclui funções de utilidade, como rand() e system().
+#include "sprite.hpp" // Sprites pré-multiplicados e o desenho com transparência.
+#include "compositing.hpp" // Escurecimento e misturas de cor no próprio quadro.
+#include "face_tracker.hpp" // Detecção que rastreia o rosto numa janela em vez de varrer o quadro inteiro.
 
 using namespace cv;
 using namespace std;
 
-void drawImage(Mat frame, Mat img, int xPos, int yPos) {
-    // Verifica se a imagem a ser desenhada está fora dos limites do quadro.
-    if (yPos + img.rows >= frame.rows || xPos + img.cols >= frame.cols || yPos < 0 || xPos < 0)
-        return; // Se estiver fora, retorna sem desenhar.
-
-    Mat mask; // Máscara para a imagem (transparente, se houver).
-    vector<Mat> layers; // Camadas da imagem (se tiver um canal alfa).
-
-    split(img, layers); // Separa a imagem em canais.
-    if (layers.size() == 4) { // Se houver 4 camadas (RGBA).
-        Mat rgb[3] = { layers[0], layers[1], layers[2] }; // RGB.
-        mask = layers[3]; // Canal alfa como máscara.
-        merge(rgb, 3, img); // Recria a imagem RGB sem o canal alfa.
-        img.copyTo(frame.rowRange(yPos, yPos + img.rows).colRange(xPos, xPos + img.cols), mask); // Desenha usando a máscara.
-    } else {
-        img.copyTo(frame.rowRange(yPos, yPos + img.rows).colRange(xPos, xPos + img.cols)); // Desenha normalmente.
-    }
-}
-
-void drawNave(Mat& background, Mat& nave, int x, int y) {
-    drawImage(background, nave, x, y); // Chama a função drawImage para desenhar a nave.
+void drawNave(Mat& background, const Sprite& nave, int x, int y) {
+    drawSprite(background, nave, x, y); // Chama a função drawSprite para desenhar a nave.
 }
 
-void drawShot(Mat& background, Mat& shot, int x, int y) {
-    drawImage(background, shot, x, y); // Chama a função drawImage para desenhar o tiro.
+void drawShot(Mat& background, const Sprite& shot, int x, int y) {
+    drawSprite(background, shot, x, y); // Chama a função drawSprite para desenhar o tiro.
 }
 
-void drawTarget(Mat& background, Mat& target, int x, int y) {
-    drawImage(background, target, x, y); // Chama a função drawImage para desenhar o alvo.
+void drawTarget(Mat& background, const Sprite& target, int x, int y) {
+    drawSprite(background, target, x, y); // Chama a função drawSprite para desenhar o alvo.
 }
 
 void drawScore(Mat& background, Ptr<freetype::FreeType2>& ft2, int score, Scalar color) {
@@ -48,9 +32,7 @@ void drawScore(Mat& background, Ptr<freetype::FreeType2>& ft2, int score, Scalar
 }
 
 void displayMessage(Mat& frame, Ptr<freetype::FreeType2>& ft2, Scalar color, const string& message) {
-    Mat overlay = Mat::zeros(frame.size(), frame.type()); // Cria uma sobreposição preta do mesmo tamanho que o quadro.
-    overlay.setTo(Scalar(0, 0, 0)); // Preenche a sobreposição de preto.
-    addWeighted(overlay, 0.5, frame, 0.5, 0, frame); // Aplica transparência à sobreposição sobre o quadro.
+    scaleInPlace(frame, 0.5); // Escurece o quadro pela metade numa passada, no próprio buffer.
 
     int fontScale = 80; // Tamanho da fonte.
     int baseline = 0; // Baseline da fonte.
@@ -104,6 +86,13 @@ int main() {
             return -1; // Encerra o programa se houver erro.
         }
 
+        FaceTrackerParams trackerParams; // Parâmetros do detectMultiScale e do rastreamento.
+        trackerParams.scaleFactor = 1.1; // Fator de escala entre as buscas.
+        trackerParams.minNeighbors = 4; // Vizinhos mínimos para aceitar um rosto.
+        DetectionScaleParams scaling; // Resolução da detecção.
+        scaling.scale = 2; // Procura no quadro reduzido pela metade: um quarto dos pixels para o cascade.
+        ScaledFaceTracker tracker(face_cascade, trackerParams, scaling); // Busca no quadro inteiro só para achar o rosto; depois rastreia.
+
         VideoCapture cap(0); // Abre o vídeo.
         //VideoCapture cap("rtsp://192.168.42.117:8080/h264_ulaw.sdp"); // Abre o vídeo.
         if (!cap.isOpened()) { // Verifica se o vídeo foi aberto corretamente.
@@ -117,23 +106,26 @@ int main() {
             return -1; // Encerra o programa se houver erro.
         }
 
-        Mat nave = imread("nave.png", IMREAD_UNCHANGED); // Carrega a imagem da nave.
-        if (nave.empty()) { // Verifica se a nave foi carregada corretamente.
+        Mat naveImg = imread("nave.png", IMREAD_UNCHANGED); // Carrega a imagem da nave.
+        if (naveImg.empty()) { // Verifica se a nave foi carregada corretamente.
             cout << "Erro ao carregar a nave!" << endl; // Mensagem de erro.
             return -1; // Encerra o programa se houver erro.
         }
+        Sprite nave(naveImg); // Converte uma única vez para o formato pré-multiplicado.
 
-        Mat shot = imread("shot.png", IMREAD_UNCHANGED); // Carrega a imagem do tiro.
-        if (shot.empty()) { // Verifica se o tiro foi carregado corretamente.
+        Mat shotImg = imread("shot.png", IMREAD_UNCHANGED); // Carrega a imagem do tiro.
+        if (shotImg.empty()) { // Verifica se o tiro foi carregado corretamente.
             cout << "Erro ao carregar o tiro!" << endl; // Mensagem de erro.
             return -1; // Encerra o programa se houver erro.
         }
+        Sprite shot(shotImg); // Converte uma única vez para o formato pré-multiplicado.
 
-        Mat target = imread("target.png", IMREAD_UNCHANGED); // Carrega a imagem do alvo.
-        if (target.empty()) { // Verifica se o alvo foi carregado corretamente.
+        Mat targetImg = imread("target.png", IMREAD_UNCHANGED); // Carrega a imagem do alvo.
+        if (targetImg.empty()) { // Verifica se o alvo foi carregado corretamente.
             cout << "Erro ao carregar o alvo!" << endl; // Mensagem de erro.
             return -1; // Encerra o programa se houver erro.
         }
+        Sprite target(targetImg); // Converte uma única vez para o formato pré-multiplicado.
 
         // Configurações do jogo.
         int naveX = 0; // Posição inicial da nave em X.
@@ -142,18 +134,20 @@ int main() {
         int shotX = -1, shotY = -1; // Posição do tiro.
         bool isShotFired = false; // Verifica se o tiro foi disparado.
 
+        // Buffers reaproveitados entre os frames (mesmo tamanho a cada quadro, então não realocam).
+        Mat frame; // Matriz para o quadro da câmera.
+        Mat gray; // Matriz para o quadro em escala de cinza.
+        vector<Rect> faces; // Vetor para armazenar as faces detectadas.
+
         while (true) { // Loop principal do jogo.
-            Mat frame; // Matriz para o quadro da câmera.
             cap >> frame; // Captura o quadro da câmera.
             if (frame.empty()) break; // Se o quadro estiver vazio, sai do loop.
 
             flip(frame, frame, 1); // Inverte o quadro horizontalmente.
 
-            Mat gray; // Matriz para o quadro em escala de cinza.
             cvtColor(frame, gray, COLOR_BGR2GRAY); // Converte o quadro para escala de cinza.
 
-            vector<Rect> faces; // Vetor para armazenar as faces detectadas.
-            face_cascade.detectMultiScale(gray, faces, 1.1, 4); // Detecta rostos.
+            tracker.detect(gray, faces); // Detecta o rosto (na janela em volta do último, se estiver rastreando), já em coordenadas do quadro.
 
             // Desenho da nave e lógica de disparo.
             if (!faces.empty()) { // Se rostos foram detectados.
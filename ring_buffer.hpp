@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic> // Contadores atômicos usados pela fila sem trava.
+#include <cstddef> // size_t.
+#include <cstdint> // Tipos inteiros de tamanho fixo.
+#include <memory> // unique_ptr para o vetor de células.
+#include <utility> // std::move.
+
+/**
+ * @brief Fila circular limitada entre um produtor e um consumidor, sem travas.
+ *
+ * Quando a fila está cheia o produtor descarta o item mais antigo ("drop oldest")
+ * em vez de esperar, de modo que um consumidor lento nunca trava quem produz e
+ * sempre encontra os dados mais novos. Segue o esquema de números de sequência
+ * por célula (Vyukov): o próprio produtor age como um segundo consumidor ao
+ * descartar, o que é seguro porque a retirada é feita por CAS.
+ *
+ * @tparam T tipo armazenado; precisa ser construtível por padrão e movível.
+ */
+template <typename T>
+class RingBuffer {
+public:
+    /**
+     * @param capacity número máximo de itens guardados (arredondado para potência de 2).
+     */
+    explicit RingBuffer(size_t capacity = 4) {
+        size_t size = 2;
+        while (size < capacity)
+            size <<= 1;
+        mask = size - 1;
+        cells.reset(new Cell[size]);
+        for (size_t i = 0; i < size; i++)
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    /**
+     * @brief Insere um item; se a fila estiver cheia, descarta o mais antigo.
+     * @return true se algum item antigo foi descartado para abrir espaço.
+     */
+    bool push(T value) {
+        bool dropped = false;
+        while (!tryPush(value)) {
+            T discarded;
+            if (tryPop(discarded)) { // Abre espaço jogando fora o mais antigo.
+                dropped = true;
+                droppedCount.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        return dropped;
+    }
+
+    /**
+     * @brief Retira o item mais antigo, sem bloquear.
+     * @return false se a fila estava vazia.
+     */
+    bool pop(T& out) {
+        return tryPop(out);
+    }
+
+    /**
+     * @brief Esvazia a fila e fica só com o item mais novo, sem bloquear.
+     * @return false se a fila estava vazia.
+     */
+    bool popLatest(T& out) {
+        if (!tryPop(out))
+            return false;
+        while (tryPop(out)) {
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    /** @brief Total de itens descartados (por fila cheia ou por popLatest). */
+    uint64_t dropped() const {
+        return droppedCount.load(std::memory_order_relaxed);
+    }
+
+    size_t capacity() const {
+        return mask + 1;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    bool tryPush(T& value) {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.data = std::move(value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // Cheia (ou o consumidor ainda está lendo esta célula).
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool tryPop(T& out) {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    out = std::move(cell.data);
+                    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // Vazia.
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    alignas(64) std::atomic<size_t> enqueuePos{0};
+    alignas(64) std::atomic<size_t> dequeuePos{0};
+    alignas(64) std::atomic<uint64_t> droppedCount{0};
+};
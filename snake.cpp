@@ -1,23 +1,28 @@
 #include <opencv2/opencv.hpp>
 #include <iostream>
-#include <deque>
+#include <cstdio>
 #include <cstdlib>
 #include <ctime>
+#include "face_tracker.hpp"
+#include "snake_board.hpp"
 
 using namespace cv;
 using namespace std;
 
 class SnakeGame {
 public:
-    SnakeGame() : score(0), gameOver(false), gridSize(20), snakeDirection(3) { // Começa movendo para a direita
-        srand(static_cast<unsigned>(time(0)));
+    /**
+     * @param cols, rows tamanho do tabuleiro, em células.
+     * @param cellSize lado de cada célula na tela, em pixels.
+     */
+    SnakeGame(int cols = 20, int rows = 20, int cellSize = 20)
+        : score(0), gameOver(false), snakeDirection(SnakeDirection::Right), // Começa movendo para a direita
+          board(cols, rows, static_cast<unsigned>(time(0))), canvas(cellSize), faceTracker(faceCascade, trackerParams()) {
         cv::namedWindow("Snake Game");
-        if (!faceCascade.load("haarcascade_frontalface_default.xml")) {
+        if (!faceCascade.loadPreferCompiled("haarcascade_frontalface_default.xml")) {
             cerr << "Erro ao carregar o classificador de rosto!" << endl;
             exit(1);
         }
-        spawnFood();
-        initSnake();
     }
 
     void run() {
@@ -43,13 +48,8 @@ public:
                 break;
             }
 
-            Mat gameFrame(400, 400, CV_8UC3, Scalar(0, 0, 0)); // Frame do jogo
             moveSnake();
-            drawSnake(gameFrame);
-            drawFood(gameFrame);
-            showScore(gameFrame);
-
-            imshow("Snake Game", gameFrame);
+            imshow("Snake Game", canvas.update(board, score)); // Só as células que mudaram são pintadas de novo.
             if (waitKey(100) == 27) break; // Pressionar 'Esc' para sair
         }
 
@@ -60,71 +60,33 @@ public:
 private:
     int score;
     bool gameOver;
-    const int gridSize;
-    int snakeDirection; // 0: Cima, 1: Baixo, 2: Esquerda, 3: Direita
-    deque<Point> snake;
-    Point food;
-    CascadeClassifier faceCascade;
-
-    void initSnake() {
-        snake.push_front(Point(10, 10)); // Cobrinha começa com um segmento
-    }
-
-    void spawnFood() {
-        food.x = rand() % (400 / gridSize);
-        food.y = rand() % (400 / gridSize);
+    SnakeDirection snakeDirection;
+    SnakeBoard board; // Cobra, comida e a grade de ocupação.
+    SnakeCanvas canvas; // Tela do jogo, mantida entre os ticks.
+    HaarDetector faceCascade; // Cascade de rosto com o kernel SIMD
+    FaceTracker faceTracker; // Acha o rosto no quadro inteiro e depois só o rastreia
+
+    static FaceTrackerParams trackerParams() {
+        FaceTrackerParams params;
+        params.scaleFactor = 1.1;
+        params.minNeighbors = 3;
+        params.minSize = Size(30, 30); // Ajustar tamanho mínimo
+        return params;
     }
 
     void moveSnake() {
-        Point head = snake.front();
-        switch (snakeDirection) {
-            case 0: head.y -= 1; break; // Cima
-            case 1: head.y += 1; break; // Baixo
-            case 2: head.x -= 1; break; // Esquerda
-            case 3: head.x += 1; break; // Direita
-        }
-
-        if (head.x < 0 || head.x >= (400 / gridSize) || head.y < 0 || head.y >= (400 / gridSize)) {
-            gameOver = true;
-            return;
-        }
-
-        for (const auto& segment : snake) {
-            if (segment == head) {
-                gameOver = true;
-                return;
-            }
-        }
-
-        snake.push_front(head); // Adiciona a nova cabeça
-
-        if (head == food) {
+        SnakeStep result = board.step(snakeDirection);
+        if (result == SnakeStep::Ate || result == SnakeStep::Filled)
             score++;
-            spawnFood(); // Gera novo alimento
-        } else {
-            snake.pop_back(); // Remove o último segmento se não comeu
-        }
-    }
-
-    void drawSnake(Mat& frame) {
-        for (const auto& segment : snake) {
-            rectangle(frame, Rect(segment.x * gridSize, segment.y * gridSize, gridSize, gridSize), Scalar(0, 255, 0), -1);
-        }
-    }
-
-    void drawFood(Mat& frame) {
-        rectangle(frame, Rect(food.x * gridSize, food.y * gridSize, gridSize, gridSize), Scalar(0, 0, 255), -1);
-    }
-
-    void showScore(Mat& frame) {
-        putText(frame, "Score: " + to_string(score), Point(10, 30), FONT_HERSHEY_SIMPLEX, 1, Scalar(255, 255, 255), 2);
+        if (result == SnakeStep::HitWall || result == SnakeStep::HitSelf || result == SnakeStep::Filled)
+            gameOver = true; // Bateu, ou a cobra encheu o tabuleiro.
     }
 
     void detectFace(Mat& frame) {
         vector<Rect> faces;
         Mat gray;
         cvtColor(frame, gray, COLOR_BGR2GRAY);
-        faceCascade.detectMultiScale(gray, faces, 1.1, 3, 0, Size(30, 30)); // Ajustar tamanho mínimo
+        faceTracker.detect(gray, faces);
 
         if (!faces.empty()) {
             Rect face = faces[0]; // Considera apenas o primeiro rosto detectado
@@ -132,20 +94,32 @@ private:
 
             // Define a direção da cobrinha com base na posição do rosto
             if (center.y < frame.rows / 3) {
-                snakeDirection = 0; // Cima
+                snakeDirection = SnakeDirection::Up; // Cima
             } else if (center.y > 2 * frame.rows / 3) {
-                snakeDirection = 1; // Baixo
+                snakeDirection = SnakeDirection::Down; // Baixo
             } else if (center.x < frame.cols / 3) {
-                snakeDirection = 2; // Esquerda
+                snakeDirection = SnakeDirection::Left; // Esquerda
             } else if (center.x > 2 * frame.cols / 3) {
-                snakeDirection = 3; // Direita
+                snakeDirection = SnakeDirection::Right; // Direita
             }
         }
     }
 };
 
-int main() {
-    SnakeGame game;
+int main(int argc, char** argv) {
+    // ./snake [--board 40x30] [--cell 10]: tamanho do tabuleiro em células e lado da célula em pixels.
+    int cols = 20, rows = 20, cellSize = 20;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--board" && hasValue && sscanf(argv[++i], "%dx%d", &cols, &rows) == 2 && cols > 0 && rows > 0)
+            continue;
+        if (arg == "--cell" && hasValue && (cellSize = atoi(argv[++i])) > 0)
+            continue;
+        cout << "Uso: " << argv[0] << " [--board LxA] [--cell px]" << endl;
+        return -1;
+    }
+    SnakeGame game(cols, rows, cellSize);
     game.run();
     return 0;
 }
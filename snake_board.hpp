@@ -0,0 +1,264 @@
+#pragma once
+
+#include <opencv2/core.hpp> // Point, Mat.
+#include <opencv2/imgproc.hpp> // rectangle e putText do SnakeCanvas.
+#include <cstddef> // size_t.
+#include <cstdint> // uint32_t, uint64_t.
+#include <cstdio> // snprintf do placar.
+#include <cstdlib> // std::abs.
+#include <deque> // Segmentos da cobra.
+#include <random> // Sorteio da comida.
+#include <utility> // std::swap.
+#include <vector> // Grade de ocupação e lista de células livres.
+
+/** @brief Direção da cobra. */
+enum class SnakeDirection { Up = 0, Down = 1, Left = 2, Right = 3 };
+
+/** @brief Resultado de um passo da cobra. */
+enum class SnakeStep { Moved, Ate, HitWall, HitSelf, Filled };
+
+/**
+ * @brief Tabuleiro da cobrinha: a cobra, a comida e uma grade de ocupação sempre em dia.
+ *
+ * A grade é um bitset com um bit por célula, atualizado junto com a deque da cobra
+ * (cabeça entra, cauda sai), então a colisão da cabeça com o corpo é um teste de bit,
+ * O(1) qualquer que seja o tamanho da cobra.
+ *
+ * As células livres ficam numa permutação de todas as células: as freeCount primeiras
+ * estão livres, e slotOf diz onde cada célula está. Ocupar ou liberar uma célula é uma
+ * troca com a fronteira, e a comida sai de um índice sorteado entre as livres, uniforme
+ * e nunca em cima da cobra, sem tentar de novo.
+ *
+ * A grade e a permutação são alocadas no construtor, do tamanho do tabuleiro; o custo
+ * de um passo não cresce com o comprimento da cobra.
+ */
+class SnakeBoard {
+public:
+    /**
+     * @param cols, rows tamanho do tabuleiro, em células.
+     * @param seed semente do sorteio da comida.
+     */
+    SnakeBoard(int cols, int rows, unsigned seed = 1) : cols(cols), rows(rows), rng(seed) {
+        size_t cells = (size_t)cols * rows;
+        occupied.assign((cells + 63) / 64, 0);
+        freeCells.resize(cells);
+        slotOf.resize(cells);
+        reset(cv::Point(cols / 2, rows / 2));
+    }
+
+    /** @brief Recomeça com a cobra de um segmento em start e uma comida nova. */
+    void reset(cv::Point start) {
+        for (const cv::Point& p : body)
+            clearBit(index(p));
+        body.clear();
+        pendingGrowth = 0;
+        freeCount = (uint32_t)freeCells.size();
+        for (uint32_t c = 0; c < freeCount; c++) {
+            freeCells[c] = c;
+            slotOf[c] = c;
+        }
+        occupy(start);
+        body.push_front(start);
+        spawnFood();
+    }
+
+    /**
+     * @brief Anda uma célula na direção dir.
+     *
+     * A cabeça não pode entrar em nenhum segmento, nem na cauda que sairia neste passo.
+     */
+    SnakeStep step(SnakeDirection dir) {
+        cv::Point head = body.front();
+        switch (dir) {
+            case SnakeDirection::Up: head.y -= 1; break;
+            case SnakeDirection::Down: head.y += 1; break;
+            case SnakeDirection::Left: head.x -= 1; break;
+            case SnakeDirection::Right: head.x += 1; break;
+        }
+        if (!inside(head))
+            return SnakeStep::HitWall;
+        if (isOccupied(head))
+            return SnakeStep::HitSelf;
+
+        occupy(head);
+        body.push_front(head); // Adiciona a nova cabeça.
+        if (head == foodCell)
+            return spawnFood() ? SnakeStep::Ate : SnakeStep::Filled;
+        if (pendingGrowth > 0) { // Ainda crescendo: a cauda fica.
+            pendingGrowth--;
+            return SnakeStep::Moved;
+        }
+        release(body.back()); // Remove o último segmento se não comeu.
+        body.pop_back();
+        return SnakeStep::Moved;
+    }
+
+    /** @brief Os próximos segments passos crescem a cobra, como se ela tivesse comido. */
+    void grow(int segments) {
+        pendingGrowth += segments;
+    }
+
+    bool inside(cv::Point p) const {
+        return p.x >= 0 && p.x < cols && p.y >= 0 && p.y < rows;
+    }
+
+    /** @brief A célula tem um segmento da cobra (p precisa estar dentro do tabuleiro). */
+    bool isOccupied(cv::Point p) const {
+        size_t c = index(p);
+        return (occupied[c >> 6] >> (c & 63)) & 1;
+    }
+
+    const std::deque<cv::Point>& snake() const {
+        return body;
+    }
+
+    cv::Point food() const {
+        return foodCell;
+    }
+
+    /** @brief Células sem cobra. */
+    size_t freeCellCount() const {
+        return freeCount;
+    }
+
+    int width() const {
+        return cols;
+    }
+
+    int height() const {
+        return rows;
+    }
+
+private:
+    size_t index(cv::Point p) const {
+        return (size_t)p.y * cols + p.x;
+    }
+
+    void clearBit(size_t c) {
+        occupied[c >> 6] &= ~(1ull << (c & 63));
+    }
+
+    // Marca a célula e a tira da parte livre da permutação (troca com a última livre).
+    void occupy(cv::Point p) {
+        uint32_t c = (uint32_t)index(p);
+        occupied[c >> 6] |= 1ull << (c & 63);
+        uint32_t slot = slotOf[c], last = --freeCount;
+        std::swap(freeCells[slot], freeCells[last]);
+        slotOf[freeCells[slot]] = slot;
+        slotOf[c] = last;
+    }
+
+    // Desmarca a célula e a devolve à parte livre (troca com a primeira ocupada).
+    void release(cv::Point p) {
+        uint32_t c = (uint32_t)index(p);
+        clearBit(c);
+        uint32_t slot = slotOf[c], first = freeCount++;
+        std::swap(freeCells[slot], freeCells[first]);
+        slotOf[freeCells[slot]] = slot;
+        slotOf[c] = first;
+    }
+
+    // Sorteia a comida entre as células livres; false se a cobra ocupa o tabuleiro todo.
+    bool spawnFood() {
+        if (freeCount == 0)
+            return false;
+        uint32_t c = freeCells[std::uniform_int_distribution<uint32_t>(0, freeCount - 1)(rng)];
+        foodCell = cv::Point((int)(c % cols), (int)(c / cols));
+        return true;
+    }
+
+    int cols, rows;
+    std::deque<cv::Point> body; // Segmentos, da cabeça à cauda.
+    cv::Point foodCell;
+    std::vector<uint64_t> occupied; // Um bit por célula: tem um segmento.
+    std::vector<uint32_t> freeCells; // Permutação das células; as freeCount primeiras estão livres.
+    std::vector<uint32_t> slotOf; // Posição de cada célula em freeCells.
+    uint32_t freeCount = 0;
+    long pendingGrowth = 0; // Passos que ainda não soltam a cauda.
+    std::mt19937 rng;
+};
+
+/**
+ * @brief Tela da cobrinha mantida entre os ticks e atualizada só nas células que mudaram.
+ *
+ * Entre dois passos mudam no máximo a célula da nova cabeça, a da cauda que saiu e a
+ * da comida; update() pinta só essas, então o custo do desenho não depende do tamanho
+ * da cobra nem do tabuleiro. O placar fica numa faixa acima do tabuleiro, refeita só
+ * quando a pontuação muda.
+ *
+ * update() precisa ser chamado depois de cada passo. Se a cobra andou mais de uma
+ * célula desde a última chamada, foi recomeçada ou invalidate() foi chamado, a tela é
+ * redesenhada inteira.
+ */
+class SnakeCanvas {
+public:
+    static const int scoreHeight = 40; // Altura da faixa do placar.
+
+    explicit SnakeCanvas(int cellSize = 20) : cellSize(cellSize) {}
+
+    /** @brief Força o redesenho completo na próxima atualização. */
+    void invalidate() {
+        fullRedraw = true;
+    }
+
+    /** @brief Atualiza a tela com o estado atual de board e devolve a imagem pronta para mostrar. */
+    const cv::Mat& update(const SnakeBoard& board, int score) {
+        const std::deque<cv::Point>& snake = board.snake();
+        cv::Size size(board.width() * cellSize, board.height() * cellSize + scoreHeight);
+        cv::Point head = snake.front();
+        bool adjacent = std::abs(head.x - lastHead.x) + std::abs(head.y - lastHead.y) <= 1;
+        bool grewByOne = snake.size() == lastLength || snake.size() == lastLength + 1;
+        bool resized = canvas.size() != size;
+        if (resized)
+            canvas.create(size, CV_8UC3);
+        if (fullRedraw || resized || !adjacent || !grewByOne) {
+            redraw(board, score);
+        } else {
+            if (!board.isOccupied(lastTail)) // A cauda saiu.
+                fillCell(lastTail, emptyColor);
+            fillCell(head, snakeColor);
+            if (board.food() != lastFood) {
+                fillCell(lastFood, board.isOccupied(lastFood) ? snakeColor : emptyColor);
+                fillCell(board.food(), foodColor);
+            }
+            if (score != lastScore)
+                drawScore(score);
+        }
+        lastHead = head;
+        lastTail = snake.back();
+        lastFood = board.food();
+        lastLength = snake.size();
+        return canvas;
+    }
+
+private:
+    void redraw(const SnakeBoard& board, int score) {
+        canvas.setTo(emptyColor);
+        for (const cv::Point& segment : board.snake())
+            fillCell(segment, snakeColor);
+        fillCell(board.food(), foodColor);
+        drawScore(score);
+        fullRedraw = false;
+    }
+
+    void fillCell(cv::Point cell, const cv::Scalar& color) {
+        cv::rectangle(canvas, cv::Rect(cell.x * cellSize, cell.y * cellSize + scoreHeight, cellSize, cellSize), color, -1);
+    }
+
+    void drawScore(int score) {
+        cv::Mat strip = canvas.rowRange(0, scoreHeight);
+        strip.setTo(emptyColor);
+        char text[32];
+        std::snprintf(text, sizeof(text), "Score: %d", score);
+        cv::putText(strip, text, cv::Point(10, 30), cv::FONT_HERSHEY_SIMPLEX, 1, cv::Scalar(255, 255, 255), 2);
+        lastScore = score;
+    }
+
+    const cv::Scalar emptyColor{ 0, 0, 0 }, snakeColor{ 0, 255, 0 }, foodColor{ 0, 0, 255 };
+    int cellSize;
+    cv::Mat canvas; // Faixa do placar e, abaixo, o tabuleiro.
+    bool fullRedraw = true;
+    cv::Point lastHead, lastTail, lastFood; // Como estavam na última atualização.
+    size_t lastLength = 0;
+    int lastScore = 0;
+};
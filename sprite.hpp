@@ -0,0 +1,140 @@
+#pragma once
+
+#include <opencv2/core.hpp> // Mat, Rect e tipos básicos do OpenCV.
+#include <opencv2/imgproc.hpp> // cvtColor.
+#include <algorithm> // std::min, std::max.
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h> // Intrínsecos SSE2/AVX2 usados no blend.
+#endif
+
+/**
+ * @brief Imagem pronta para desenhar com transparência.
+ *
+ * O PNG é convertido uma única vez, na carga, em dois planos BGR do mesmo tamanho:
+ * a cor já multiplicada pelo alfa e o alfa invertido (255 - a) repetido nos três
+ * canais. Assim o desenho vira uma conta byte a byte, sem split/merge nem máscara:
+ * dst = cor + dst * (255 - a) / 255.
+ */
+struct Sprite {
+    cv::Mat color; // BGR pré-multiplicado pelo alfa (CV_8UC3).
+    cv::Mat invAlpha; // 255 - alfa, repetido por canal (CV_8UC3); vazio se a imagem for opaca.
+    cv::Mat alpha; // Canal alfa original (CV_8UC1); vazio se a imagem for opaca.
+    int cols = 0; // Largura em pixels.
+    int rows = 0; // Altura em pixels.
+
+    Sprite() {}
+
+    /**
+     * @param img imagem BGR, BGRA ou cinza, como lida por imread com IMREAD_UNCHANGED.
+     */
+    explicit Sprite(const cv::Mat& img) {
+        CV_Assert(img.depth() == CV_8U && (img.channels() == 1 || img.channels() == 3 || img.channels() == 4));
+        cols = img.cols;
+        rows = img.rows;
+        if (img.channels() == 1) { // Cinza: converte para BGR opaco.
+            cv::cvtColor(img, color, cv::COLOR_GRAY2BGR);
+            return;
+        }
+        if (img.channels() == 3) { // Sem transparência: basta copiar.
+            color = img.clone();
+            return;
+        }
+        color.create(rows, cols, CV_8UC3);
+        invAlpha.create(rows, cols, CV_8UC3);
+        alpha.create(rows, cols, CV_8UC1);
+        for (int y = 0; y < rows; y++) {
+            const uchar* src = img.ptr<uchar>(y);
+            uchar* c = color.ptr<uchar>(y);
+            uchar* ia = invAlpha.ptr<uchar>(y);
+            uchar* a = alpha.ptr<uchar>(y);
+            for (int x = 0; x < cols; x++, src += 4, c += 3, ia += 3) {
+                int alphaValue = src[3];
+                for (int k = 0; k < 3; k++) {
+                    c[k] = (uchar)((src[k] * alphaValue + 127) / 255); // Pré-multiplica a cor.
+                    ia[k] = (uchar)(255 - alphaValue);
+                }
+                a[x] = (uchar)alphaValue;
+            }
+        }
+    }
+
+    bool empty() const {
+        return color.empty();
+    }
+
+    bool opaque() const {
+        return invAlpha.empty();
+    }
+
+    cv::Size size() const {
+        return cv::Size(cols, rows);
+    }
+};
+
+/**
+ * @brief Mistura uma linha: dst[i] = src[i] + dst[i] * inv[i] / 255, para n bytes.
+ */
+inline void blendPremultipliedRow(uchar* dst, const uchar* src, const uchar* inv, int n) {
+    int i = 0;
+#if defined(__AVX2__)
+    const __m256i zero256 = _mm256_setzero_si256();
+    const __m256i half256 = _mm256_set1_epi16(128);
+    for (; i + 32 <= n; i += 32) {
+        __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i a = _mm256_loadu_si256((const __m256i*)(inv + i));
+        __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero256), _mm256_unpacklo_epi8(a, zero256)), half256);
+        __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero256), _mm256_unpackhi_epi8(a, zero256)), half256);
+        lo = _mm256_srli_epi16(_mm256_add_epi16(lo, _mm256_srli_epi16(lo, 8)), 8); // Divisão exata por 255.
+        hi = _mm256_srli_epi16(_mm256_add_epi16(hi, _mm256_srli_epi16(hi, 8)), 8);
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_adds_epu8(_mm256_packus_epi16(lo, hi), s));
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi16(128);
+    for (; i + 16 <= n; i += 16) {
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i a = _mm_loadu_si128((const __m128i*)(inv + i));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(a, zero)), half);
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(a, zero)), half);
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8); // Divisão exata por 255.
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_adds_epu8(_mm_packus_epi16(lo, hi), s));
+    }
+#endif
+    for (; i < n; i++) {
+        int t = dst[i] * inv[i] + 128;
+        int v = src[i] + ((t + (t >> 8)) >> 8);
+        dst[i] = (uchar)(v > 255 ? 255 : v);
+    }
+}
+
+/**
+ * @brief Desenha um sprite sobre um quadro BGR, recortando o que ficar fora da tela.
+ *
+ * @param frame quadro CV_8UC3 onde o sprite será desenhado.
+ * @param sprite sprite já convertido.
+ * @param xPos posição x do canto superior esquerdo (pode ser negativa).
+ * @param yPos posição y do canto superior esquerdo (pode ser negativa).
+ */
+inline void drawSprite(cv::Mat& frame, const Sprite& sprite, int xPos, int yPos) {
+    CV_Assert(frame.type() == CV_8UC3);
+    int x0 = std::max(xPos, 0), y0 = std::max(yPos, 0); // Recorte contra as bordas do quadro.
+    int x1 = std::min(xPos + sprite.cols, frame.cols), y1 = std::min(yPos + sprite.rows, frame.rows);
+    if (x0 >= x1 || y0 >= y1)
+        return; // Totalmente fora da tela.
+
+    int width = (x1 - x0) * 3; // Bytes por linha a desenhar.
+    int sx = (x0 - xPos) * 3; // Deslocamento dentro do sprite.
+    for (int y = y0; y < y1; y++) {
+        uchar* dst = frame.ptr<uchar>(y) + x0 * 3;
+        const uchar* src = sprite.color.ptr<uchar>(y - yPos) + sx;
+        if (sprite.opaque())
+            std::copy(src, src + width, dst);
+        else
+            blendPremultipliedRow(dst, src, sprite.invAlpha.ptr<uchar>(y - yPos) + sx, width);
+    }
+}
@@ -5,292 +5,920 @@
 #include <vector> // Inclui a biblioteca para usar vetores dinâmicos.
 #include <chrono> // Inclui suporte para manipulação de tempo.
 #include <cstdlib> // Inclui funções de utilidade, como rand() e system().
+#include "sprite.hpp" // Sprites pré-multiplicados e o desenho com transparência.
+#include "compositing.hpp" // Escurecimento e misturas de cor no próprio quadro.
+#include "compositor.hpp" // Tela em camadas, refeita só nas regiões que mudaram.
+#include <thread> // Inclui suporte para as threads de captura e detecção.
+#include <atomic> // Inclui flags atômicas compartilhadas entre as threads.
+#include "ring_buffer.hpp" // Fila circular sem trava que liga os estágios do pipeline.
+#include "text_renderer.hpp" // Texto com glifos em cache, sem rasterizar a fonte a cada frame.
+#include "face_tracker.hpp" // Detecção que rastreia o rosto numa janela em vez de varrer o quadro inteiro.
+#include "face_filter.hpp" // Suavização e previsão da posição do rosto entre as detecções.
+#include "profiler.hpp" // Tempo de cada etapa do frame (overlay e trace do Chrome).
+#include "capture.hpp" // Captura numa thread própria que guarda só o quadro mais novo.
+#include "alloc_counter.hpp" // Contagem de alocações para o --check-alloc (com -DALLOC_COUNTER).
+#include "entity_store.hpp" // Tiros, alvos e explosões em estrutura de arrays.
+#include "collision_grid.hpp" // Grade uniforme para a colisão (broad phase).
+#include "collision_mask.hpp" // Máscaras de bits dos sprites para a colisão por pixel.
+#include <random> // Gerador com semente fixa para o modo replay.
+#include <filesystem> // Lista as imagens de uma pasta no modo replay.
+#include <fstream> // Log do modo replay.
+#include <algorithm> // Ordena as imagens do replay.
+#include <cstdint> // Hash de 64 bits do estado.
+#include <cstdio> // snprintf das linhas do log.
+#include <ctime> // Semente do jogo ao vivo.
+#include <cstring> // memcpy dos bits das posições no hash.
 
 using namespace cv;
 using namespace std;
 
-void drawImage(Mat frame, Mat img, int xPos, int yPos) {
-    // Verifica se a imagem a ser desenhada está fora dos limites do quadro.
-    if (yPos + img.rows >= frame.rows || xPos + img.cols >= frame.cols || yPos < 0 || xPos < 0)
-        return; // Se estiver fora, retorna sem desenhar.
-
-    Mat mask; // Máscara para a imagem (transparente, se houver).
-    vector<Mat> layers; // Camadas da imagem (se tiver um canal alfa).
-
-    split(img, layers); // Separa a imagem em canais.
-    if (layers.size() == 4) { // Se houver 4 camadas (RGBA).
-        Mat rgb[3] = { layers[0], layers[1], layers[2] }; // RGB.
-        mask = layers[3]; // Canal alfa como máscara.
-        merge(rgb, 3, img); // Recria a imagem RGB sem o canal alfa.
-        img.copyTo(frame.rowRange(yPos, yPos + img.rows).colRange(xPos, xPos + img.cols), mask); // Desenha usando a máscara.
-    } else {
-        img.copyTo(frame.rowRange(yPos, yPos + img.rows).colRange(xPos, xPos + img.cols)); // Desenha normalmente.
-    }
+void drawScore(Compositor& scene, TextRenderer& hudText, TextLayer& scoreText, int score) {
+    char text[32];
+    snprintf(text, sizeof(text), "SCORE: %d", score); // Sem string nova a cada frame.
+    scoreText.set(text); // Só re-renderiza quando a pontuação muda.
+    Size textSize = hudText.glyphsSize("0"); // Altura dos dígitos.
+    scene.addText(scoreText, Point(10, textSize.height + 10)); // Camada do HUD, por cima dos sprites.
 }
 
-void drawNave(Mat& background, Mat& nave, int x, int y) {
-    drawImage(background, nave, x, y); // Chama a função drawImage para desenhar a nave.
+// Fundo das telas de mensagem: o quadro escurecido pela metade, feito uma vez ao entrar na tela.
+void dimBackground(const Mat& frame, Mat& dimmed) {
+    frame.copyTo(dimmed); // Buffer reaproveitado entre as telas.
+    scaleInPlace(dimmed, 0.5); // Escurece numa passada, no próprio buffer.
 }
 
-void drawShot(Mat& background, Mat& shot, int x, int y) {
-    drawImage(background, shot, x, y); // Chama a função drawImage para desenhar o tiro.
+// Mensagem centralizada na camada do HUD; a tela só é refeita onde o texto muda.
+void displayMessage(Compositor& scene, Size screen, TextLayer& messageText, const char* message) {
+    messageText.set(message);
+    Size textSize = messageText.textSize(); // Tamanho do texto pelos glifos do atlas.
+    Point textOrg((screen.width - textSize.width) / 2, (screen.height + textSize.height) / 2); // Centraliza o texto.
+    scene.addText(messageText, textOrg);
 }
 
-void drawTarget(Mat& background, Mat& target, int x, int y) {
-    drawImage(background, target, x, y); // Chama a função drawImage para desenhar o alvo.
+// Mensagem "FASE n", montada sem alocar.
+void displayPhase(Compositor& scene, Size screen, TextLayer& messageText, int phase) {
+    char message[32];
+    snprintf(message, sizeof(message), "FASE %d", phase);
+    displayMessage(scene, screen, messageText, message);
 }
 
-void drawScore(Mat& background, Ptr<freetype::FreeType2>& ft2, int score, Scalar color) {
-    int fontScale = 30; // Tamanho da fonte.
-    int baseline = 0; // Baseline da fonte (ajuste vertical).
-    Size textSize = ft2->getTextSize(to_string(score), fontScale, LINE_AA, &baseline); // Calcula o tamanho do texto.
-    ft2->putText(background, "SCORE: " + to_string(score), Point(10, textSize.height + 10), fontScale, color, cv::FILLED, LINE_AA, true); // Desenha o texto no fundo.
-}
+// Desenha o menu estático (título e opções) uma única vez numa camada pronta para exibir.
+Mat renderMenuLayer(const Mat& background, TextRenderer& bigText, TextRenderer& menuText, Scalar colorTitulo, Scalar colorMenu) {
+    Mat layer = background.clone(); // Camada do menu, separada do fundo original.
+    int centerX = layer.cols / 2; // Calcula a posição central em X.
+    int centerY = layer.rows / 2; // Calcula a posição central em Y.
 
-void displayMessage(Mat& frame, Ptr<freetype::FreeType2>& ft2, Scalar color, const string& message) {
-    Mat overlay = Mat::zeros(frame.size(), frame.type()); // Cria uma sobreposição preta do mesmo tamanho que o quadro.
-    overlay.setTo(Scalar(0, 0, 0)); // Preenche a sobreposição de preto.
-    addWeighted(overlay, 0.5, frame, 0.5, 0, frame); // Aplica transparência à sobreposição sobre o quadro.
+    Size textSize = bigText.textSize("CIs SPACE"); // Calcula o tamanho do título.
+    bigText.draw(layer, "CIs SPACE", Point(centerX - textSize.width / 2, centerY - 250), colorTitulo); // Desenha o título.
 
-    int fontScale = 80; // Tamanho da fonte.
-    int baseline = 0; // Baseline da fonte.
-    Size textSize = ft2->getTextSize(message, fontScale, LINE_AA, &baseline); // Calcula o tamanho do texto.
-    Point textOrg((frame.cols - textSize.width) / 2, (frame.rows + textSize.height) / 2); // Centraliza o texto.
+    textSize = menuText.textSize("START"); // Calcula o tamanho da opção "START".
+    menuText.draw(layer, "START", Point(centerX - textSize.width / 2, centerY - 70), colorMenu); // Desenha a opção "START".
 
-    ft2->putText(frame, message, textOrg, fontScale, color, cv::FILLED, LINE_AA, true); // Desenha a mensagem no quadro.
+    textSize = menuText.textSize("CREDITS"); // Calcula o tamanho da opção "CREDITS".
+    menuText.draw(layer, "CREDITS", Point(centerX - textSize.width / 2, centerY), colorMenu); // Desenha a opção "CREDITS".
+
+    textSize = menuText.textSize("EXIT"); // Calcula o tamanho da opção "EXIT".
+    menuText.draw(layer, "EXIT", Point(centerX - textSize.width / 2, centerY + 70), colorMenu); // Desenha a opção "EXIT".
+    return layer;
 }
 
-int main() {
-    string wName = "CIs Space"; // Nome da janela.
+// Sprites e fundo usados na partida.
+struct GameAssets {
+    Mat background; // Fundo do jogo.
+    Sprite nave, shot, target, explosion; // Sprites já no formato pré-multiplicado.
+    CollisionMask naveMask, shotMask, targetMask; // Pixels sólidos de cada sprite, para a colisão.
+};
+
+// Carrega uma imagem com transparência, redimensiona e converte uma única vez para Sprite.
+bool loadSprite(const string& file, Size size, Sprite& sprite) {
+    Mat img = imread(file, IMREAD_UNCHANGED); // Carrega a imagem com o canal alfa.
+    if (img.empty())
+        return false;
+    resize(img, img, size); // Redimensiona para o tamanho usado no jogo.
+    sprite = Sprite(img);
+    return true;
+}
 
-    Mat background = imread("cenarioMenu.png"); // Carrega o fundo do menu.
-    if (background.empty()) { // Verifica se o fundo foi carregado corretamente.
-        cout << "Erro ao carregar o fundo do menu!" << endl; // Mensagem de erro.
-        return -1; // Encerra o programa se houver erro.
+bool loadGameAssets(GameAssets& assets) {
+    assets.background = imread("cenarioMenu.png"); // Carrega o fundo do jogo.
+    if (assets.background.empty()) { // Verifica se o fundo foi carregado corretamente.
+        cout << "Erro ao carregar o fundo do jogo!" << endl; // Mensagem de erro.
+        return false;
+    }
+    if (!loadSprite("nave.png", Size(80, 80), assets.nave)) { // Carrega a imagem da nave.
+        cout << "Erro ao carregar a imagem da nave!" << endl; // Mensagem de erro.
+        return false;
+    }
+    if (!loadSprite("Shot.png", Size(20, 10), assets.shot)) { // Carrega a imagem do tiro.
+        cout << "Erro ao carregar a imagem do tiro!" << endl; // Mensagem de erro.
+        return false;
+    }
+    if (!loadSprite("target.png", Size(100, 100), assets.target)) { // Carrega a imagem do alvo.
+        cout << "Erro ao carregar a imagem do alvo!" << endl; // Mensagem de erro.
+        return false;
+    }
+    if (!loadSprite("explosion.png", Size(80, 80), assets.explosion)) { // Carrega a imagem da explosão.
+        cout << "Erro ao carregar a imagem da explosão!" << endl; // Mensagem de erro.
+        return false;
     }
+    assets.naveMask = CollisionMask(assets.nave); // Máscaras montadas uma vez, a partir do alfa.
+    assets.shotMask = CollisionMask(assets.shot);
+    assets.targetMask = CollisionMask(assets.target);
+    return true;
+}
 
-    Ptr<freetype::FreeType2> ft2 = freetype::createFreeType2(); // Cria um objeto FreeType2 para renderização de texto.
-    ft2->loadFontData("arcadeclassic.ttf", 0); // Carrega a fonte.
+const int naveY = 700; // Altura fixa da nave.
+
+// A simulação anda sempre em ticks de 1/60 s, qualquer que seja a taxa da câmera, da detecção
+// ou da tela. As velocidades são as do jogo original, que movia 15 e 8 px por frame a ~30 fps.
+const double tickSeconds = 1.0 / 60; // Duração de um tick.
+const float shotSpeed = 450 * tickSeconds; // Tiro, em px por tick (para cima).
+const float targetSpeed = 240 * tickSeconds; // Alvo, em px por tick (para baixo).
+const long shotIntervalTicks = 180; // 3 segundos entre tiros.
+const double maxFrameSeconds = 0.25; // Um frame travado não vira uma rajada de ticks.
+
+// Duração das telas de transição, contadas no relógio do jogo (a simulação fica parada nelas).
+const double phaseSeconds = 3; // "FASE n".
+const double explosionSeconds = 3; // Explosão da nave.
+const double gameOverSeconds = 3; // "GAME OVER".
+const double creditsSeconds = 3; // Créditos.
+
+// Segundos do relógio monotônico, base de tempo das amostras de rosto e do acumulador.
+double steadySeconds() {
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
 
-    Scalar colorTitulo = Scalar(255, 209, 1); // Define a cor do título.
-    Scalar colorMenu = Scalar(255, 255, 255); // Define a cor do menu.
-    int centerX = background.cols / 2; // Calcula a posição central em X.
-    int centerY = background.rows / 2; // Calcula a posição central em Y.
+// Resultado de uma detecção com o instante (steadySeconds) do quadro em que foi feita.
+struct FaceSample {
+    vector<Rect> faces; // Rostos encontrados.
+    double time = 0; // Momento da captura do quadro.
+};
+
+// Fila de tamanho fixo das amostras que ainda não valem. Troca (swap) os vetores de rostos
+// em vez de copiá-los, então nem a fila nem as amostras alocam depois dos primeiros frames.
+struct FaceQueue {
+    static const size_t capacity = 8;
+    FaceSample slots[capacity];
+    size_t head = 0; // Amostra mais antiga.
+    size_t count = 0; // Amostras na fila.
+
+    bool empty() const {
+        return count == 0;
+    }
 
-    int fontScale = 80; // Tamanho da fonte do título.
-    int baseline = 0; // Baseline da fonte.
-    Size textSize = ft2->getTextSize("CIs SPACE", fontScale, LINE_AA, &baseline); // Calcula o tamanho do título.
-    ft2->putText(background, "CIs SPACE", Point(centerX - textSize.width / 2, centerY - 250), fontScale, colorTitulo, cv::FILLED, LINE_AA, true); // Desenha o título no fundo.
+    FaceSample& front() {
+        return slots[head];
+    }
 
-    fontScale = 45; // Tamanho da fonte para opções de menu.
-    textSize = ft2->getTextSize("START", fontScale, LINE_AA, &baseline); // Calcula o tamanho da opção "START".
-    ft2->putText(background, "START", Point(centerX - textSize.width / 2, centerY - 70), fontScale, colorMenu, cv::FILLED, LINE_AA, true); // Desenha a opção "START".
+    void pop() {
+        head = (head + 1) % capacity;
+        count--;
+    }
 
-    textSize = ft2->getTextSize("CREDITS", fontScale, LINE_AA, &baseline); // Calcula o tamanho da opção "CREDITS".
-    ft2->putText(background, "CREDITS", Point(centerX - textSize.width / 2, centerY), fontScale, colorMenu, cv::FILLED, LINE_AA, true); // Desenha a opção "CREDITS".
+    // Entra com a amostra; sample fica com o vetor antigo do slot, para ser reaproveitado.
+    void push(FaceSample& sample) {
+        if (count == capacity) // Cheia: descarta a mais antiga.
+            pop();
+        swap(slots[(head + count) % capacity], sample);
+        count++;
+    }
+};
+
+// Estado da partida: tudo o que a simulação lê e altera a cada tick.
+struct GameState {
+    EntityStore entities; // Tiros, alvos e explosões.
+    long ticks = 0; // Ticks simulados.
+    long lastShotTick = -shotIntervalTicks; // Tick do último tiro (o primeiro sai logo no começo).
+    int score = 0; // Pontuação do jogador.
+    bool gameOver = false; // Indica se o jogo acabou.
+    int hits = 0; // Acertos na fase atual.
+    int phase = 1; // Próxima fase a ser anunciada.
+    int h = 0; // Contador de fases.
+    int naveX = 0; // Posição horizontal da nave.
+    int prevNaveX = 0; // Posição da nave no tick anterior.
+    FaceSample face; // Amostra de rosto em uso pela simulação.
+    FaceQueue pendingFaces; // Amostras que chegaram e ainda não valem (são de depois do tick atual).
+    FaceFilter faceFilter; // Posição do rosto suavizada, prevista para o instante de cada tick.
+    bool faceTracked = false; // O filtro tem um rosto neste tick.
+    Rect trackedFace; // Rosto previsto para o fim do tick.
+    double accumulator = 0; // Tempo já passado e ainda não simulado.
+    CollisionGrid targetGrid{ 100 }; // Alvos por célula (lado = maior sprite), remontada a cada tick.
+};
+
+// Se a fase acabou (5 acertos) ou o jogo está começando, passa para a próxima e devolve o número a anunciar; senão 0.
+int advancePhase(GameState& state) {
+    if (state.hits < 5 && state.h != 0)
+        return 0;
+    state.hits = 0; // Reseta o contador de acertos.
+    state.h++; // Incrementa o contador de fases.
+    return state.phase++; // Avança para a próxima fase.
+}
 
-    textSize = ft2->getTextSize("EXIT", fontScale, LINE_AA, &baseline); // Calcula o tamanho da opção "EXIT".
-    ft2->putText(background, "EXIT", Point(centerX - textSize.width / 2, centerY + 70), fontScale, colorMenu, cv::FILLED, LINE_AA, true); // Desenha a opção "EXIT".
+// Um tick da partida: nave, tiros, alvos e colisões.
+void updateGame(GameState& state, mt19937& rng, const GameAssets& assets, int frameCols) {
+    state.prevNaveX = state.naveX;
+    state.naveX = 0; // Sem rosto, a nave fica na esquerda.
+    if (state.faceTracked) { // Se há um rosto (detectado ou previsto pelo filtro).
+        const Rect& face = state.trackedFace;
+        state.naveX = face.x + face.width / 2 - assets.nave.cols / 2; // Posiciona a nave em relação ao rosto.
+        state.naveX = min(max(state.naveX, 0), frameCols - assets.nave.cols); // Garante que a nave não saia dos limites.
+    }
 
-    imshow(wName, background); // Exibe o fundo do menu na janela.
+    EntityStore& e = state.entities;
+    e.step(); // Move tiros e alvos com as suas velocidades.
 
-    int key = waitKey(0); // Espera por uma tecla ser pressionada.
-    if (key == '1') { // Se a tecla '1' for pressionada.
-        destroyWindow(wName); // Fecha a janela do menu.
+    // Adiciona novos alvos se houver menos de 10.
+    if (e.count(EntityType::Target) < 10) {
+        int x = (int)(rng() % (unsigned)(assets.background.cols - 100)); // Gera posição aleatória para o alvo.
+        e.spawn(EntityType::Target, (float)x, -(float)(rng() % 500), 0, targetSpeed); // Começa fora da tela.
+    }
 
-        CascadeClassifier face_cascade; // Classificador de rostos.
-        if (!face_cascade.load("haarcascade_frontalface_default.xml")) { // Tenta carregar o classificador de rostos.
-            cout << "Erro ao carregar o classificador de rosto!" << endl; // Mensagem de erro.
-            return -1; // Encerra o programa se houver erro.
+    // Broad phase: grade com os alvos; o narrow phase compara as máscaras dos sprites (pixels sólidos).
+    CollisionGrid& grid = state.targetGrid;
+    grid.setCellSize((float)max(assets.target.cols, assets.target.rows));
+    grid.build(e, EntityType::Target, (float)assets.target.cols, (float)assets.target.rows);
+    grid.query((float)state.naveX, (float)naveY, (float)assets.nave.cols, (float)assets.nave.rows, [&](size_t j) {
+        if (masksOverlap(assets.naveMask, state.naveX, naveY, assets.targetMask, cvRound(e.x[j]), cvRound(e.y[j])))
+            state.gameOver = true; // Se um alvo atingiu a nave, o jogo acaba.
+        return !state.gameOver;
+    });
+    if (state.gameOver)
+        e.spawn(EntityType::Explosion, (float)state.naveX, (float)naveY); // Explosão no lugar da nave.
+
+    for (size_t i = 0; i < e.size(); i++) { // Verifica colisões entre tiros e alvos.
+        if (e.type[i] != EntityType::Shot)
+            continue;
+        if (e.y[i] < 0) { // Se o tiro sai da tela.
+            e.kill(i);
+            continue;
         }
+        grid.query(e.x[i], e.y[i], (float)assets.shot.cols, (float)assets.shot.rows, [&](size_t j) {
+            // Se o tiro atinge um alvo que ainda não foi atingido neste tick.
+            if (!e.alive[j] || !masksOverlap(assets.shotMask, cvRound(e.x[i]), cvRound(e.y[i]),
+                                             assets.targetMask, cvRound(e.x[j]), cvRound(e.y[j])))
+                return true;
+            e.kill(j); // Remove o alvo.
+            state.score += 100; // Incrementa a pontuação.
+            state.hits++; // Incrementa o contador de acertos.
+            e.kill(i); // Remove o tiro.
+            return false; // Um tiro acerta um alvo só.
+        });
+    }
+    e.removeDead(); // Tira de uma vez os tiros e alvos mortos (swap-and-pop).
 
-        //VideoCapture cap("video.mp4"); // Abre o vídeo.
-        VideoCapture cap("rtsp://192.168.42.117:8080/h264_ulaw.sdp"); // Abre o vídeo.
-        if (!cap.isOpened()) { // Verifica se o vídeo foi aberto corretamente.
-            cout << "Erro ao abrir a câmera!" << endl; // Mensagem de erro.
-            return -1; // Encerra o programa se houver erro.
-        }
+    state.ticks++;
+    if (state.ticks - state.lastShotTick >= shotIntervalTicks) { // Se passaram 3 segundos desde o último tiro.
+        state.entities.spawn(EntityType::Shot, (float)(state.naveX + 45), (float)(naveY - 10), 0, -shotSpeed); // Adiciona um novo tiro.
+        state.lastShotTick = state.ticks; // Atualiza o tick do último tiro.
+    }
+}
 
-        Mat gameBackground = imread("cenarioMenu.png"); // Carrega o fundo do jogo.
-        if (gameBackground.empty()) { // Verifica se o fundo foi carregado corretamente.
-            cout << "Erro ao carregar o fundo do jogo!" << endl; // Mensagem de erro.
-            return -1; // Encerra o programa se houver erro.
+/**
+ * @brief Avança a partida até now (steadySeconds ou relógio do replay), em ticks fixos.
+ *
+ * frameSeconds (o tempo desde a última chamada) vai para o acumulador, e rodam tantos
+ * ticks quanto couberem nele. Cada tick passa ao filtro as amostras de rosto capturadas
+ * até o fim dele e usa o rosto previsto para esse instante, então a partida não depende
+ * de quantos frames a tela ou a detecção fazem, e a nave anda a cada tick mesmo com a
+ * detecção mais lenta.
+ * @return fração do próximo tick que já passou (0 a 1), para interpolar o desenho.
+ */
+double advanceGame(GameState& state, double now, double frameSeconds, mt19937& rng, const GameAssets& assets, int frameCols) {
+    state.accumulator += min(frameSeconds, maxFrameSeconds);
+    while (state.accumulator >= tickSeconds && !state.gameOver) {
+        double tickEnd = now - state.accumulator + tickSeconds; // Instante em que este tick termina.
+        while (!state.pendingFaces.empty() && state.pendingFaces.front().time <= tickEnd) {
+            swap(state.face, state.pendingFaces.front());
+            state.pendingFaces.pop();
+            if (state.face.faces.empty())
+                state.faceFilter.miss(state.face.time);
+            else
+                state.faceFilter.update(state.face.faces[0], state.face.time);
         }
+        state.faceTracked = state.faceFilter.predict(tickEnd, state.trackedFace);
+        updateGame(state, rng, assets, frameCols);
+        state.accumulator -= tickSeconds;
+    }
+    return min(state.accumulator / tickSeconds, 1.0);
+}
 
-        Mat nave = imread("nave.png", IMREAD_UNCHANGED); // Carrega a imagem da nave.
-        if (nave.empty()) { // Verifica se a nave foi carregada corretamente.
-            cout << "Erro ao carregar a imagem da nave!" << endl; // Mensagem de erro.
-            return -1; // Encerra o programa se houver erro.
+// Monta a partida sobre o fundo da cena (o quadro da câmera), interpolando alpha (0 a 1) entre o tick anterior e o atual.
+// Só lista os sprites; quem desenha é o compose(), e só onde algo mudou ("sprites" e "texto" são medidos lá).
+void drawGame(Compositor& scene, const GameState& state, double alpha, const GameAssets& assets, TextRenderer& hudText,
+              TextLayer& scoreText) {
+    const vector<Rect>& faces = state.face.faces;
+    if (state.faceTracked) { // Se há um rosto, mesmo que só previsto.
+        int naveX = cvRound(state.prevNaveX + (state.naveX - state.prevNaveX) * alpha);
+        scene.addSprite(assets.nave, Point(naveX, naveY)); // Nave.
+    }
+    if (!faces.empty())
+        scene.addRectangle(faces[0], Scalar(255, 0, 0), 3); // Rosto detectado (cru, sem o filtro).
+    const EntityStore& e = state.entities;
+    for (size_t i = 0; i < e.size(); i++) { // Todos os tiros e alvos.
+        Point p(cvRound(e.prevX[i] + (e.x[i] - e.prevX[i]) * alpha), cvRound(e.prevY[i] + (e.y[i] - e.prevY[i]) * alpha));
+        if (e.type[i] == EntityType::Shot)
+            scene.addSprite(assets.shot, p);
+        else if (e.type[i] == EntityType::Target)
+            scene.addSprite(assets.target, p);
+    }
+    drawScore(scene, hudText, scoreText, state.score); // Pontuação na camada do HUD.
+}
+
+// Hash FNV-1a do estado da partida (e do rosto usado), para comparar execuções do replay.
+uint64_t hashState(const GameState& state) {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](int64_t value) {
+        for (int i = 0; i < 8; i++) {
+            hash ^= (uint64_t)(value >> (i * 8)) & 0xff;
+            hash *= 1099511628211ull;
         }
-        resize(nave, nave, Size(80, 80)); // Redimensiona a nave.
+    };
+    auto mixFloat = [&mix](float value) { // Bits exatos da coordenada.
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        mix(bits);
+    };
+    mix(state.score);
+    mix(state.hits);
+    mix(state.phase);
+    mix(state.gameOver);
+    mix(state.naveX);
+    mix(state.ticks);
+    mix(state.lastShotTick);
+    const EntityStore& e = state.entities;
+    mix((int64_t)e.size());
+    for (size_t i = 0; i < e.size(); i++) {
+        mix((int)e.type[i]);
+        mixFloat(e.x[i]);
+        mixFloat(e.y[i]);
+    }
+    mix((int64_t)state.face.faces.size());
+    for (const Rect& r : state.face.faces) {
+        mix(r.x);
+        mix(r.y);
+        mix(r.width);
+        mix(r.height);
+    }
+    mix(state.faceTracked); // Rosto filtrado que a simulação usou.
+    if (state.faceTracked) {
+        mix(state.trackedFace.x);
+        mix(state.trackedFace.y);
+    }
+    return hash;
+}
 
-        Mat shot = imread("Shot.png",
+// Resultado de uma detecção, passado da thread de detecção para o render.
+struct FaceResult {
+    FaceSample sample; // Rostos encontrados e o momento da captura do quadro.
+    int64 frameId = -1; // Quadro que originou a detecção.
+};
+
+// Parâmetros da detecção, os mesmos no jogo ao vivo e no replay.
+FaceTrackerParams detectionParams() {
+    FaceTrackerParams params; // Parâmetros do detectMultiScale e do rastreamento.
+    params.scaleFactor = 1.5; // Fator de escala entre as buscas.
+    params.minNeighbors = 2; // Vizinhos mínimos para aceitar um rosto.
+    params.flags = CASCADE_SCALE_IMAGE; // Redimensiona a imagem em vez do classificador.
+    params.minSize = Size(50, 50); // Menor rosto aceito.
+    return params;
+}
 
- IMREAD_UNCHANGED); // Carrega a imagem do tiro.
-        if (shot.empty()) { // Verifica se o tiro foi carregado corretamente.
-            cout << "Erro ao carregar a imagem do tiro!" << endl; // Mensagem de erro.
-            return -1; // Encerra o programa se houver erro.
+// Detecção na resolução cheia, com o histograma equalizado na própria imagem da detecção.
+DetectionScaleParams defaultDetectionScale() {
+    DetectionScaleParams scaling;
+    scaling.equalize = true; // Melhora o contraste antes do cascade.
+    return scaling;
+}
+
+// Opções da linha de comando (ver main).
+struct GameOptions {
+    string source; // Vídeo ou pasta de imagens.
+    unsigned seed = 1; // Semente do gerador dos alvos.
+    double dtMs = 1000.0 / 30; // Intervalo entre os quadros da gravação (a simulação anda em ticks de 1/60 s).
+    long maxFrames = 0; // Para depois de tantos frames (0 = até o fim da fonte).
+    string logFile; // CSV com hash e tempos por frame (vazio = saída padrão).
+    string traceFile; // Trace do Chrome gravado no fim (vazio = não grava).
+    bool overlay = false; // Começa com a tabela de tempos por etapa na tela.
+    bool checkAlloc = false; // Replay falha se a simulação e o render alocarem depois do aquecimento.
+    string camera = "rtsp://192.168.42.117:8080/h264_ulaw.sdp"; // Fonte do jogo ao vivo (URL, arquivo ou índice da câmera).
+    CaptureOptions capture; // Resolução pedida à câmera e loop de arquivo.
+    DetectionScaleParams detection = defaultDetectionScale(); // Resolução da detecção (fixa ou pelo tempo alvo).
+    double detectIntervalMs = 0; // Intervalo mínimo entre detecções (0 = todo quadro); o filtro cobre o meio.
+};
+
+// Fonte de quadros do replay: um arquivo de vídeo ou uma pasta de imagens, lidas em ordem alfabética.
+class ReplaySource {
+public:
+    bool open(const string& path) {
+        if (filesystem::is_directory(path)) {
+            for (const auto& entry : filesystem::directory_iterator(path))
+                if (entry.is_regular_file())
+                    files.push_back(entry.path().string());
+            sort(files.begin(), files.end());
+            return !files.empty();
         }
-        resize(shot, shot, Size(20, 10)); // Redimensiona o tiro.
+        return cap.open(path);
+    }
 
-        Mat target = imread("target.png", IMREAD_UNCHANGED); // Carrega a imagem do alvo.
-        if (target.empty()) { // Verifica se o alvo foi carregado corretamente.
-            cout << "Erro ao carregar a imagem do alvo!" << endl; // Mensagem de erro.
-            return -1; // Encerra o programa se houver erro.
+    bool read(Mat& frame) {
+        if (files.empty())
+            return cap.read(frame);
+        while (next < files.size()) { // Pula arquivos que não são imagens.
+            frame = imread(files[next++]);
+            if (!frame.empty())
+                return true;
         }
-        resize(target, target, Size(100, 100)); // Redimensiona o alvo.
+        return false;
+    }
 
-        Mat explosion = imread("explosion.png", IMREAD_UNCHANGED); // Carrega a imagem da explosão.
-        if (explosion.empty()) { // Verifica se a explosão foi carregada corretamente.
-            cout << "Erro ao carregar a imagem da explosão!" << endl; // Mensagem de erro.
-            return -1; // Encerra o programa se houver erro.
+private:
+    VideoCapture cap;
+    vector<string> files;
+    size_t next = 0;
+};
+
+// Roda a partida sem janela, a partir de um vídeo gravado, com semente e passo de tempo fixos.
+// Cada frame é detectado (sem descartar nenhum), simulado e desenhado; o log traz o hash do estado e os tempos.
+int runReplay(const GameOptions& options) {
+    HaarDetector face_cascade; // Classificador de rostos.
+    if (!face_cascade.loadPreferCompiled("haarcascade_frontalface_default.xml")) {
+        cout << "Erro ao carregar o classificador de rosto!" << endl;
+        return -1;
+    }
+    ReplaySource source;
+    if (!source.open(options.source)) {
+        cout << "Erro ao abrir " << options.source << endl;
+        return -1;
+    }
+    GameAssets assets;
+    if (!loadGameAssets(assets))
+        return -1;
+    Ptr<freetype::FreeType2> ft2 = freetype::createFreeType2(); // O texto também é desenhado, para medir o render inteiro.
+    ft2->loadFontData("arcadeclassic.ttf", 0);
+    TextRenderer bigText(ft2, 80);
+    TextRenderer hudText(ft2, 30);
+    Scalar colorMenu = Scalar(255, 255, 255);
+    TextLayer scoreText(hudText, colorMenu), messageText(bigText, colorMenu);
+    scoreText.reserve("SCORE: 00000000"); // Buffers do maior texto: trocar o texto não aloca.
+    messageText.reserve("FASE 000");
+
+    ofstream logFile;
+    if (!options.logFile.empty()) {
+        logFile.open(options.logFile);
+        if (!logFile) {
+            cout << "Erro ao criar " << options.logFile << endl;
+            return -1;
         }
-        resize(explosion, explosion, Size(80, 80)); // Redimensiona a explosão.
-
-        vector<Rect> faces; // Vetor para armazenar rostos detectados.
-        vector<Point> shots; // Vetor para armazenar as posições dos tiros.
-        vector<Point> targets; // Vetor para armazenar as posições dos alvos.
-        int lastShotTime = 0; // Armazena o tempo do último tiro.
-        int score = 0; // Inicializa a pontuação do jogador.
-        bool gameOver = false; // Indica se o jogo acabou.
-        Point explosionPos; // Posição da explosão.
-        int hits = 0; // Contador de acertos.
-        int phase = 1; // Fase atual do jogo.
-
-        int h = 0; // Contador de fases.
-
-        while (true) { // Loop principal do jogo.
-            if (gameOver) { // Se o jogo acabou.
-                Mat display = gameBackground.clone(); // Clona o fundo do jogo.
-                drawImage(display, explosion, explosionPos.x, explosionPos.y); // Desenha a explosão.
-                imshow(wName, display); // Mostra a explosão.
-                waitKey(3000); // Espera 3 segundos.
-
-                // Desenha a tela "GAME OVER".
-                displayMessage(display, ft2, colorMenu, "GAME OVER"); // Chama a função para exibir a mensagem de Game Over.
-                imshow(wName, display); // Mostra a mensagem.
-                waitKey(3000); // Espera 3 segundos para mostrar a tela de GAME OVER.
-                break; // Sai do loop e volta ao menu.
-            }
-            Mat display;
-            //Mat frame; // Matriz para armazenar cada frame do vídeo.
-            cap >> display; // Captura o próximo frame do vídeo.
-            if (display.empty()) { // Verifica se o frame foi capturado corretamente.
-                cout << "Erro ao capturar frame!" << endl; // Mensagem de erro.
-                break; // Sai do loop se houver erro.
+    }
+    ostream& log = options.logFile.empty() ? cout : logFile;
+    PROFILE_THREAD("replay");
+    log << "frame,hash,detect_ms,update_ms,render_ms\n";
+
+    ScaledFaceTracker tracker(face_cascade, detectionParams(), options.detection);
+    GameState state;
+    mt19937 rng(options.seed); // Mesma sequência de alvos em qualquer máquina.
+    FaceSample sample;
+    Mat frame, gray, dimmed;
+    Compositor scene; // Quadro, sprites e HUD.
+    double clock = 0; // Momento do quadro atual na gravação, em segundos.
+    double lastDetect = -1e9; // Momento do último quadro detectado.
+    double totalMs[3] = { 0, 0, 0 }; // Detecção, simulação e render.
+    double totalBytes = 0; // Bytes escritos pelo compose().
+    uint64_t runHash = 14695981039346656037ull; // Hash de todos os frames, em sequência.
+    long frames = 0;
+    const long warmupFrames = 60; // Primeiros frames de partida: vetores e buffers ainda crescendo até o tamanho final.
+    long playFrames = 0; // Frames simulados (fora da tela de fase).
+    int phase = 0; // Fase anunciada na tela de fase.
+    double phaseEnd = -1; // Fim da tela de fase, no relógio da gravação.
+    size_t steadyAllocations = 0; // Alocações da simulação e do render depois do aquecimento.
+    if (options.checkAlloc && !AllocationCounter::enabled()) {
+        cout << "--check-alloc precisa do programa compilado com -DALLOC_COUNTER" << endl;
+        return -1;
+    }
+    while ((options.maxFrames <= 0 || frames < options.maxFrames) && !state.gameOver && source.read(frame)) {
+        int64 t0 = getTickCount();
+        if ((clock - lastDetect) * 1000 >= options.detectIntervalMs - 1e-6) { // No relógio da gravação: reproduzível.
+            {
+                PROFILE_SCOPE("cvtColor");
+                cvtColor(frame, gray, COLOR_BGR2GRAY);
             }
-            //Mat display = gameBackground.clone(); // Clona o fundo do jogo.
-
-            if (hits >= 5 || h==0) { // Se o jogador acertou 5 alvos ou é a primeira fase.
-                hits = 0; // Reseta o contador de acertos.
-                displayMessage(display, ft2, colorMenu, "FASE " + to_string(phase)); // Mostra a fase atual.
-                imshow(wName, display); // Exibe a fase.
-                waitKey(3000); // Espera 3 segundos.
-                h++; // Incrementa o contador de fases.
-                phase++; // Avança para a próxima fase.
-                continue; // Volta ao início do loop.
+            {
+                PROFILE_SCOPE("deteccao"); // Redução, equalização e cascade.
+                tracker.detect(gray, sample.faces);
             }
+            sample.time = clock;
+            state.pendingFaces.push(sample);
+            lastDetect = clock;
+        }
+        int64 t1 = getTickCount();
+        AllocationCounter allocations; // Só a simulação e o render (a detecção fica de fora).
+        int next = advancePhase(state);
+        if (next) { // Como no jogo ao vivo, a simulação fica parada durante a tela de fase.
+            phase = next;
+            phaseEnd = clock + phaseSeconds;
+            dimBackground(frame, dimmed); // O quadro em que a fase começou, escurecido.
+        }
+        bool intro = clock < phaseEnd;
+        double alpha = 0;
+        if (!intro) {
+            playFrames++;
+            PROFILE_SCOPE("simulacao");
+            alpha = advanceGame(state, clock + options.dtMs / 1000, options.dtMs / 1000, rng, assets, frame.cols);
+        }
+        int64 t2 = getTickCount();
+        if (intro) {
+            scene.setBackground(dimmed, next != 0);
+            displayPhase(scene, frame.size(), messageText, phase);
+        } else {
+            scene.setBackground(frame, true); // Cada frame da gravação é um quadro novo.
+            drawGame(scene, state, alpha, assets, hudText, scoreText);
+        }
+        Mat& display = scene.compose();
+        totalBytes += scene.bytesTouched();
+        if (playFrames > warmupFrames)
+            steadyAllocations += allocations.count(); // Sem o overlay, que monta tabelas a cada frame.
+#ifndef PROFILER_DISABLED
+        if (options.overlay)
+            scene.invalidate(Profiler::instance().drawOverlay(display)); // Desenhado por fora da cena.
+#else
+        (void)display; // Sem o overlay, o quadro montado só entra nos tempos.
+#endif
+        int64 t3 = getTickCount();
+        clock += options.dtMs / 1000;
+
+        double ms[3] = { (t1 - t0) * 1000.0 / getTickFrequency(), (t2 - t1) * 1000.0 / getTickFrequency(),
+                         (t3 - t2) * 1000.0 / getTickFrequency() };
+        uint64_t hash = hashState(state);
+        runHash = (runHash ^ hash) * 1099511628211ull;
+        char line[128];
+        snprintf(line, sizeof(line), "%ld,%016llx,%.3f,%.3f,%.3f\n", frames, (unsigned long long)hash, ms[0], ms[1], ms[2]);
+        log << line;
+        for (int i = 0; i < 3; i++)
+            totalMs[i] += ms[i];
+        frames++;
+    }
+    if (frames == 0) {
+        cout << "Nenhum quadro lido de " << options.source << endl;
+        return -1;
+    }
+    char summary[256];
+    snprintf(summary, sizeof(summary),
+             "# %ld frames, hash %016llx, pontos %d%s; media por frame: deteccao %.2f ms, simulacao %.3f ms, render %.2f ms"
+             " (%.0f KB escritos)\n",
+             frames, (unsigned long long)runHash, state.score, state.gameOver ? ", game over" : "",
+             totalMs[0] / frames, totalMs[1] / frames, totalMs[2] / frames, totalBytes / frames / 1024);
+    log << summary;
+    if (!options.logFile.empty())
+        cout << summary;
+    if (!options.traceFile.empty() && !Profiler::instance().exportChromeTrace(options.traceFile))
+        cout << "Erro ao gravar " << options.traceFile << endl;
+    if (options.checkAlloc) {
+        cout << "Alocacoes na simulacao e no render depois de " << warmupFrames << " frames de partida: " << steadyAllocations << endl;
+        if (steadyAllocations > 0)
+            return 1; // Falha: o laço em regime alocou memória.
+    }
+    return 0;
+}
 
-            
-
-            Mat gray; // Matriz para a imagem em escala de cinza.
-            cvtColor(display, gray, COLOR_BGR2GRAY); // Converte o frame para escala de cinza.
-            equalizeHist(gray, gray); // Equaliza o histograma da imagem em escala de cinza para melhorar o contraste.
-            //face_cascade.detectMultiScale(gray, faces); // Detecta rostos na imagem em escala de cinza.
-            face_cascade.detectMultiScale( gray, faces,
-                    1.5, 2, 0
-                    //|CASCADE_FIND_BIGGEST_OBJECT
-                    //|CASCADE_DO_ROUGH_SEARCH
-                    |CASCADE_SCALE_IMAGE,
-                    Size(50, 50) );
-
-            int nave_x = 0, nave_y = 700; // Posições iniciais da nave.
-
-            if (!faces.empty()) { // Se rostos foram detectados.
-                nave_x = faces[0].x + faces[0].width / 2 - nave.cols / 2; // Posiciona a nave em relação ao rosto detectado.
-                nave_x = min(max(nave_x, 0), display.cols - nave.cols); // Garante que a nave não saia dos limites.
-                drawNave(display, nave, nave_x, nave_y); // Desenha a nave na tela.
-                rectangle( display, Point(cvRound(faces[0].x), cvRound(faces[0].y)),
-                    Point(cvRound((faces[0].x + faces[0].width-1)), cvRound((faces[0].y + faces[0].height-1))),
-                    Scalar(255,0,0), 3);
-            }
+// Consumidores da captura: cada um recebe o quadro mais novo no seu slot.
+const size_t renderConsumer = 0;
+const size_t detectConsumer = 1;
+
+void detectLoop(HaarDetector& face_cascade, DetectionScaleParams scaling, double intervalMs, FrameCapture& capture,
+                RingBuffer<FaceResult>& results, atomic<bool>& running) {
+    PROFILE_THREAD("deteccao");
+    ScaledFaceTracker tracker(face_cascade, detectionParams(), scaling); // Busca no quadro inteiro só para achar o rosto; depois rastreia.
+    CapturedFrame packet; // Último quadro recebido.
+    double lastDetect = -1e9; // Captura do quadro da última detecção.
+    while (running) {
+        if (!capture.take(detectConsumer, packet)) { // Pega só o quadro mais novo, pulando os atrasados.
+            this_thread::sleep_for(chrono::milliseconds(1)); // Nada para detectar ainda.
+            continue;
+        }
+        if ((packet.time - lastDetect) * 1000 < intervalMs)
+            continue; // Cedo demais: o filtro prevê o rosto até a próxima detecção.
+        lastDetect = packet.time;
+        FaceResult result; // Resultado desta detecção.
+        result.frameId = packet.id; // Guarda de qual quadro veio.
+        result.sample.time = packet.time; // A amostra vale a partir do momento em que o quadro foi capturado.
+        {
+            PROFILE_SCOPE("deteccao"); // Reduz e equaliza a imagem e roda o cascade; os rostos voltam em coordenadas do quadro.
+            tracker.detect(packet.gray, result.sample.faces); // Detecta o rosto (na janela em volta do último, se estiver rastreando).
+        }
+        results.push(std::move(result)); // Publica o resultado para o render.
+    }
+}
 
-            for (size_t i = 0; i < shots.size(); i++) { // Atualiza a posição dos tiros.
-                shots[i].y -= 15; // Move o tiro para cima.
-                if (shots[i].y < 0) { // Se o tiro sai da tela.
-                    shots.erase(shots.begin() + i); // Remove o tiro do vetor.
-                    i--; // Decrementa o índice para evitar pular tiros.
-                }
-            }
+// Captura e detecção nas suas threads. Ligadas no primeiro START e mantidas até o fim: nas telas de
+// fase, explosão, fim de jogo e créditos elas continuam consumindo quadros, então a partida volta com
+// o quadro mais novo e o rastreamento em dia, sem o atraso que o RTSP acumularia com o render parado.
+struct LivePipeline {
+    HaarDetector face_cascade; // Classificador de rostos (kernel SIMD, em paralelo no pool de threads).
+    FrameCapture capture{ 2 }; // Câmera: um slot para o render e um para a detecção.
+    RingBuffer<FaceResult> faceResults{ 4 }; // Detecções esperando o render.
+    atomic<bool> running{ false }; // Mantém a detecção viva enquanto o jogo roda.
+    thread detectThread;
+
+    bool started() const {
+        return running;
+    }
 
-            for (const auto& shotPos : shots) { // Desenha todos os tiros na tela.
-                drawShot(display, shot, shotPos.x, shotPos.y);
-            }
+    bool start(const GameOptions& options) {
+        if (!face_cascade.loadPreferCompiled("haarcascade_frontalface_default.xml")) { // Tenta carregar o classificador de rostos.
+            cout << "Erro ao carregar o classificador de rosto!" << endl; // Mensagem de erro.
+            return false;
+        }
+        CaptureOptions captureOptions = options.capture;
+        captureOptions.gray = true; // O cinza da detecção sai pronto da thread da captura.
+        if (!capture.open(options.camera, captureOptions)) { // Abre o vídeo.
+            cout << "Erro ao abrir a câmera!" << endl; // Mensagem de erro.
+            return false;
+        }
+        // Pipeline: captura -> detecção -> simulação/render; cada estágio pega só o mais novo do anterior.
+        running = true;
+        capture.start(); // Inicia a captura.
+        detectThread = thread(detectLoop, ref(face_cascade), options.detection, options.detectIntervalMs, ref(capture), ref(faceResults), ref(running)); // Inicia a detecção.
+        return true;
+    }
 
-            // Adiciona novos alvos se houver menos de 10.
-            if (targets.size() < 10) {
-                int x = rand() % (gameBackground.cols - 100); // Gera posição aleatória para o alvo.
-                targets.emplace_back(x, -rand() % 500); // Adiciona o alvo no vetor, começando fora da tela.
-            }
+    void stop() {
+        running = false; // Pede para a detecção parar.
+        if (detectThread.joinable())
+            detectThread.join(); // Espera a detecção terminar.
+        capture.stop(); // Espera a captura terminar.
+    }
+};
+
+// Telas do jogo ao vivo. As de transição acabam sozinhas depois do seu tempo, sem parar o laço principal.
+enum class Screen { Menu, PhaseIntro, Playing, Exploding, GameOver, Credits };
+
+int main(int argc, char** argv) {
+    // Modo replay: ./a.out --replay video.mp4|pasta [--seed N] [--dt ms] [--frames N] [--log arquivo.csv]
+    //   --check-alloc: falha (código 1) se a simulação e o render alocarem depois do aquecimento (compilar com -DALLOC_COUNTER).
+    // Jogo ao vivo: --camera rtsp://...|video.mp4|0 escolhe a fonte; --capture-size 640x480 pede uma resolução menor;
+    //   --loop recomeça um arquivo no fim (câmera de teste sem rede).
+    // Nos dois modos: --detect-scale 2 detecta no quadro reduzido pela metade; --detect-budget 8 escolhe a redução
+    //   para a detecção levar ~8 ms (o replay deixa de ser reproduzível); --detect-crop x,y,l,a só procura nessa área;
+    //   --detect-interval 100 detecta no máximo a cada 100 ms (a nave segue a previsão do filtro entre as detecções).
+    // Nos dois modos: --trace arquivo.json grava o trace do Chrome no fim; --overlay mostra os tempos por etapa ('p' alterna).
+    GameOptions options;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--replay" && hasValue)
+            options.source = argv[++i];
+        else if (arg == "--seed" && hasValue)
+            options.seed = (unsigned)strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--dt" && hasValue)
+            options.dtMs = atof(argv[++i]);
+        else if (arg == "--frames" && hasValue)
+            options.maxFrames = atol(argv[++i]);
+        else if (arg == "--log" && hasValue)
+            options.logFile = argv[++i];
+        else if (arg == "--trace" && hasValue)
+            options.traceFile = argv[++i];
+        else if (arg == "--overlay")
+            options.overlay = true;
+        else if (arg == "--check-alloc")
+            options.checkAlloc = true;
+        else if (arg == "--camera" && hasValue)
+            options.camera = argv[++i];
+        else if (arg == "--capture-size" && hasValue) {
+            int width = 0, height = 0;
+            if (sscanf(argv[++i], "%dx%d", &width, &height) == 2)
+                options.capture.resolution = Size(width, height);
+        } else if (arg == "--loop")
+            options.capture.loop = true;
+        else if (arg == "--detect-scale" && hasValue)
+            options.detection.scale = atof(argv[++i]);
+        else if (arg == "--detect-budget" && hasValue)
+            options.detection.budgetMs = atof(argv[++i]);
+        else if (arg == "--detect-crop" && hasValue) {
+            Rect& crop = options.detection.crop;
+            if (sscanf(argv[++i], "%d,%d,%d,%d", &crop.x, &crop.y, &crop.width, &crop.height) != 4)
+                crop = Rect();
+        } else if (arg == "--detect-interval" && hasValue)
+            options.detectIntervalMs = atof(argv[++i]);
+        else {
+            cout << "Uso: " << argv[0] << " [--replay video|pasta [--seed N] [--dt ms] [--frames N] [--log arquivo.csv]]"
+                 << " [--camera fonte [--capture-size LxA] [--loop]] [--detect-scale S | --detect-budget ms] [--detect-crop x,y,l,a]"
+                 << " [--detect-interval ms]"
+                 << " [--trace arquivo.json] [--overlay] [--check-alloc]" << endl;
+            return -1;
+        }
+    }
+    if (!options.source.empty())
+        return runReplay(options);
 
-            for (size_t i = 0; i < targets.size(); i++) { // Atualiza a posição dos alvos.
-                targets[i].y += 8; // Move o alvo para baixo.
-                // Verifica se o alvo atingiu a nave.
-                if (targets[i].y >= nave_y && targets[i].x + target.cols > nave_x && targets[i].x < nave_x + nave.cols) {
-                    gameOver = true; // Se atingiu, o jogo acaba.
-                    explosionPos = Point(nave_x, nave_y); // Armazena a posição da explosão.
-                }
-            }
+    string wName = "CIs Space"; // Nome da janela.
 
-            for (size_t i = 0; i < shots.size(); i++) { // Verifica colisões entre tiros e alvos.
-                for (size_t j = 0; j < targets.size(); j++) {
-                    // Se o tiro atinge o alvo.
-                    if (abs(shots[i].x - targets[j].x) < 40 && abs(shots[i].y - targets[j].y) < 40) {
-                        targets.erase(targets.begin() + j); // Remove o alvo.
-                        score += 100; // Incrementa a pontuação.
-                        hits++; // Incrementa o contador de acertos.
-                        shots.erase(shots.begin() + i); // Remove o tiro.
-                        break; // Sai do loop para evitar múltiplas colisões.
-                    }
-                }
-            }
+    Mat background = imread("cenarioMenu.png"); // Carrega o fundo do menu.
+    if (background.empty()) { // Verifica se o fundo foi carregado corretamente.
+        cout << "Erro ao carregar o fundo do menu!" << endl; // Mensagem de erro.
+        return -1; // Encerra o programa se houver erro.
+    }
 
-            // Desenha todos os alvos na tela.
-            for (const auto& targetPos : targets) {
-                drawTarget(display, target, targetPos.x, targetPos.y);
-            }
+    Ptr<freetype::FreeType2> ft2 = freetype::createFreeType2(); // Cria um objeto FreeType2 para renderização de texto.
+    ft2->loadFontData("arcadeclassic.ttf", 0); // Carrega a fonte.
 
-            drawScore(display, ft2, score, colorMenu); // Desenha a pontuação na tela.
+    TextRenderer bigText(ft2, 80); // Glifos do título e das mensagens, rasterizados uma vez.
+    TextRenderer menuText(ft2, 45); // Glifos das opções do menu.
+    TextRenderer hudText(ft2, 30); // Glifos da pontuação e dos créditos.
 
-            imshow(wName, display); // Mostra a tela do jogo.
-            resizeWindow(wName, 1024, 768); // Redimensiona a janela.
+    Scalar colorTitulo = Scalar(255, 209, 1); // Define a cor do título.
+    Scalar colorMenu = Scalar(255, 255, 255); // Define a cor do menu.
 
-            // Checa o tempo para adicionar novos tiros.
-            auto currentTime = chrono::system_clock::now(); // Obtém o tempo atual.
-            int elapsedTime = chrono::duration_cast<chrono::seconds>(currentTime.time_since_epoch()).count(); // Calcula o tempo desde o início.
-            if (elapsedTime - lastShotTime >= 3) { // Se passaram 3 segundos desde o último tiro.
-                shots.push_back(Point(nave_x + 45, nave_y - 10)); // Adiciona um novo tiro.
-                lastShotTime = elapsedTime; // Atualiza o tempo do último tiro.
-            }
+    Mat menuLayer = renderMenuLayer(background, bigText, menuText, colorTitulo, colorMenu); // Pré-renderiza o menu numa camada.
 
-            int keyPressed = waitKey(10); // Espera por uma tecla e controla a taxa de frames.
-            if (keyPressed == '2') { // Se a tecla '2' for pressionada.
-                Mat creditsDisplay = display.clone(); // Clona a tela atual para exibir créditos.
-                creditsDisplay.setTo(Scalar(0, 0, 0)); // Preenche a tela de créditos com preto.
-                ft2->putText(creditsDisplay, "Feito por Kezia e Rayanne", Point(150, 200), 30, colorMenu, cv::FILLED, LINE_AA, true); // Desenha os créditos.
-                imshow(wName, creditsDisplay); // Mostra a tela de créditos.
-                waitKey(3000); // Espera 3 segundos.
-                continue; // Volta ao início do loop.
-            }
+    GameAssets assets; // Fundo e sprites do jogo.
+    if (!loadGameAssets(assets)) // Carrega e converte as imagens uma única vez.
+        return -1; // Encerra o programa se houver erro.
 
-            if (keyPressed == 'q' || keyPressed == 27) break; // Se 'q' ou 'ESC' for pressionado, sai do loop.
-       
+    LivePipeline pipeline; // Captura e detecção, ligadas no primeiro START.
+    GameState state; // Tiros, alvos, pontuação e fase.
+    mt19937 rng((unsigned)time(nullptr)); // Gerador das posições dos alvos.
+    CapturedFrame packet; // Último quadro recebido da captura.
+    Mat cameraFrame; // Último quadro da câmera, reaproveitado se não chegar um novo.
+    Mat display; // Tela montada (o buffer do compositor, sem cópia).
+    Mat dimmed; // Fundo escurecido das telas de mensagem.
+    Mat blank; // Fundo preto dos créditos.
+    Compositor scene; // Fundo, sprites e HUD; só o que mudou é redesenhado.
+    TextLayer scoreText(hudText, colorMenu), messageText(bigText, colorMenu); // Textos pré-renderizados.
+    TextLayer creditsText(hudText, colorMenu);
+    scoreText.reserve("SCORE: 00000000"); // Buffers do maior texto: trocar o texto não aloca.
+    messageText.reserve("FASE 000");
+    creditsText.set("Feito por Kezia e Rayanne");
+    FaceResult faceResult; // Última detecção recebida.
+    bool showProfiler = options.overlay; // Tabela de tempos por etapa na tela.
+    const double renderSeconds = 1.0 / 60; // Intervalo alvo entre dois quadros na tela.
+    double lastFrame = steadySeconds(); // Momento do último tick simulado.
+    Screen screen = Screen::Menu; // Tela atual.
+    double screenEnd = 0; // Quando a tela de transição atual acaba (0 = não acaba sozinha).
+    Screen afterCredits = Screen::Menu; // Para onde voltar depois dos créditos.
+    int phase = 0; // Fase anunciada na tela de fase.
+    PROFILE_THREAD("render");
+
+    // Troca de tela: marca o fim das telas temporizadas e prepara o fundo de cada uma.
+    auto enter = [&](Screen next) {
+        double now = steadySeconds();
+        screen = next;
+        screenEnd = 0;
+        scene.invalidateAll(); // Fundo novo.
+        switch (next) {
+        case Screen::PhaseIntro:
+            dimBackground(cameraFrame, dimmed); // O quadro em que a fase começou, escurecido.
+            screenEnd = now + phaseSeconds;
+            break;
+        case Screen::Playing:
+            lastFrame = now; // O tempo parado nas outras telas não é simulado.
+            resizeWindow(wName, 1024, 768); // Redimensiona a janela.
+            break;
+        case Screen::Exploding:
+            screenEnd = now + explosionSeconds;
+            break;
+        case Screen::GameOver:
+            dimBackground(display, dimmed); // A explosão, escurecida.
+            screenEnd = now + gameOverSeconds;
+            break;
+        case Screen::Credits:
+            blank.create(display.size(), CV_8UC3); // Tela preta do tamanho da atual.
+            blank.setTo(Scalar(0, 0, 0));
+            screenEnd = now + creditsSeconds;
+            break;
+        case Screen::Menu:
+            break;
+        }
+    };
+
+    while (true) { // Loop principal: uma volta por quadro na tela, em qualquer tela.
+        double frameStart = steadySeconds();
+        bool newFrame = false;
+        if (pipeline.started()) { // A captura e a detecção não param nas telas de transição.
+            newFrame = pipeline.capture.take(renderConsumer, packet); // Pega o quadro mais novo, sem esperar.
+            if (newFrame) {
+                cameraFrame = packet.frame;
+                packet.frame.release(); // Marca o quadro como consumido.
+            } else if (pipeline.capture.failed()) { // A captura parou e não há quadro novo.
+                cout << "Erro ao capturar frame!" << endl; // Mensagem de erro.
+                break; // Sai do loop se houver erro.
+            }
+            while (pipeline.faceResults.pop(faceResult)) // Entrega todas as detecções novas; cada tick usa a que valia no seu instante.
+                state.pendingFaces.push(faceResult.sample);
+        }
+        // Ainda não chegou nenhum quadro: a partida não anda nem é desenhada, mas as teclas continuam valendo.
+        bool waitingCamera = screen == Screen::Playing && cameraFrame.empty();
+
+        if (screenEnd > 0 && frameStart >= screenEnd) { // Fim de uma tela de transição.
+            if (screen == Screen::PhaseIntro)
+                enter(Screen::Playing);
+            else if (screen == Screen::Exploding)
+                enter(Screen::GameOver);
+            else if (screen == Screen::GameOver)
+                enter(Screen::Menu); // Volta ao menu.
+            else if (screen == Screen::Credits)
+                enter(afterCredits);
+        }
+        if (screen == Screen::Playing && !waitingCamera) {
+            int next = advancePhase(state); // Se o jogador acertou 5 alvos ou é a primeira fase.
+            if (next) {
+                phase = next;
+                enter(Screen::PhaseIntro); // Mostra a fase atual.
+            }
+        }
 
- }
-    } else if (key == '3') { // Se a tecla '3' for pressionada.
-        cout << "Saindo do jogo..." << endl; // Mensagem de saída.
-        return 0; // Encerra o programa.
+        switch (screen) {
+        case Screen::Menu:
+            scene.setBackground(menuLayer, false); // Camada pronta: parada, não redesenha nada.
+            break;
+        case Screen::PhaseIntro:
+            scene.setBackground(dimmed, false);
+            displayPhase(scene, dimmed.size(), messageText, phase);
+            break;
+        case Screen::Playing: {
+            if (waitingCamera) { // A tela anterior fica até o primeiro quadro; a espera não é simulada.
+                lastFrame = steadySeconds();
+                break;
+            }
+            double now = steadySeconds();
+            double alpha;
+            {
+                PROFILE_SCOPE("simulacao");
+                alpha = advanceGame(state, now, now - lastFrame, rng, assets, cameraFrame.cols); // Roda os ticks que couberem no tempo passado.
+            }
+            lastFrame = now;
+            scene.setBackground(cameraFrame, newFrame); // Quadro novo: tela inteira; senão só o que mudou.
+            drawGame(scene, state, alpha, assets, hudText, scoreText); // Monta a partida sobre o quadro da câmera.
+            break;
+        }
+        case Screen::Exploding: {
+            scene.setBackground(assets.background, false); // Fundo do jogo.
+            const EntityStore& e = state.entities;
+            for (size_t i = 0; i < e.size(); i++) // Desenha a explosão.
+                if (e.type[i] == EntityType::Explosion)
+                    scene.addSprite(assets.explosion, Point(cvRound(e.x[i]), cvRound(e.y[i])));
+            break;
+        }
+        case Screen::GameOver:
+            scene.setBackground(dimmed, false);
+            displayMessage(scene, dimmed.size(), messageText, "GAME OVER"); // Mensagem de Game Over.
+            break;
+        case Screen::Credits:
+            scene.setBackground(blank, false);
+            scene.addText(creditsText, Point(150, 200)); // Desenha os créditos.
+            break;
+        }
+        {
+            PROFILE_SCOPE("composicao");
+            display = scene.compose(); // Redesenha só as regiões que mudaram.
+        }
+#ifndef PROFILER_DISABLED
+        if (showProfiler) // p50/p95/p99 de cada etapa no último segundo; desenhado por fora, refeito no próximo frame.
+            scene.invalidate(Profiler::instance().drawOverlay(display));
+#endif
+        {
+            PROFILE_SCOPE("imshow");
+            imshow(wName, display); // Mostra a tela.
+        }
+        if (newFrame) // Da captura até a tela, nas mesmas tabelas de percentis das etapas.
+            PROFILE_RECORD("captura->tela", (int64_t)(packet.time * 1e9), Profiler::now());
+        if (screen == Screen::Playing && state.gameOver) // A explosão aparece a partir do próximo quadro.
+            enter(Screen::Exploding);
+
+        int waitMs = max(1, (int)((renderSeconds - (steadySeconds() - frameStart)) * 1000)); // O que sobra do quadro.
+        int keyPressed = waitKey(waitMs); // Espera por uma tecla e controla a taxa de frames.
+        if (keyPressed == 'q' || keyPressed == 27) break; // Se 'q' ou 'ESC' for pressionado, sai do loop.
+        if (keyPressed == 'p') // Liga e desliga a tabela de tempos.
+            showProfiler = !showProfiler;
+        if (screen == Screen::Menu) {
+            if (keyPressed == '1') { // START: nova partida.
+                if (!pipeline.started() && !pipeline.start(options))
+                    return -1; // Encerra o programa se houver erro.
+                state = GameState();
+                enter(Screen::Playing);
+            } else if (keyPressed == '2') { // CREDITS.
+                afterCredits = Screen::Menu;
+                enter(Screen::Credits);
+            } else if (keyPressed == '3') { // EXIT.
+                cout << "Saindo do jogo..." << endl; // Mensagem de saída.
+                break;
+            }
+        } else if (screen == Screen::Playing && keyPressed == '2') { // Créditos no meio da partida.
+            afterCredits = Screen::Playing;
+            enter(Screen::Credits);
+        }
+    }
+    pipeline.stop(); // Para a captura e a detecção.
+    if (pipeline.capture.captured() > 0) {
+        char summary[160];
+        snprintf(summary, sizeof(summary), "Quadros capturados: %llu; perdidos pela tela: %llu, pela deteccao: %llu",
+                 (unsigned long long)pipeline.capture.captured(), (unsigned long long)pipeline.capture.dropped(renderConsumer),
+                 (unsigned long long)pipeline.capture.dropped(detectConsumer));
+        cout << summary << endl;
+        for (const Profiler::StageStats& stage : Profiler::instance().stats())
+            if (stage.name == "captura->tela")
+                cout << "Latencia da captura ate a tela: p50 " << stage.p50 << " ms, p95 " << stage.p95 << " ms" << endl;
     }
+    if (!options.traceFile.empty() && !Profiler::instance().exportChromeTrace(options.traceFile)) // Grava o trace das três threads.
+        cout << "Erro ao gravar " << options.traceFile << endl;
 
     return 0; // Retorno final do programa.
 }
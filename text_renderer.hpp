@@ -0,0 +1,233 @@
+#pragma once
+
+#include <opencv2/core.hpp> // Mat e tipos básicos do OpenCV.
+#include <opencv2/imgproc.hpp> // cvtColor, boundingRect.
+#include <opencv2/freetype.hpp> // Rasterização das letras.
+#include <algorithm> // std::min, std::max.
+#include <string> // Textos.
+#include <unordered_map> // Layouts memorizados.
+
+/**
+ * @brief Mistura uma cor sólida sobre o quadro usando uma máscara alfa (CV_8UC1).
+ *
+ * @param frame quadro CV_8UC3 de destino.
+ * @param alpha máscara com a cobertura de cada pixel (0 = transparente).
+ * @param topLeft posição da máscara no quadro (pode sair da tela; o excesso é recortado).
+ * @param color cor do texto.
+ */
+inline void blendColorMask(cv::Mat& frame, const cv::Mat& alpha, cv::Point topLeft, const cv::Scalar& color) {
+    int x0 = std::max(topLeft.x, 0), y0 = std::max(topLeft.y, 0);
+    int x1 = std::min(topLeft.x + alpha.cols, frame.cols), y1 = std::min(topLeft.y + alpha.rows, frame.rows);
+    int c0 = (int)color[0], c1 = (int)color[1], c2 = (int)color[2];
+    for (int y = y0; y < y1; y++) {
+        const uchar* a = alpha.ptr<uchar>(y - topLeft.y) + (x0 - topLeft.x);
+        uchar* d = frame.ptr<uchar>(y) + x0 * 3;
+        for (int x = x0; x < x1; x++, a++, d += 3) {
+            int w = *a;
+            if (w == 0)
+                continue; // A maior parte da caixa do texto é vazia.
+            d[0] = (uchar)(d[0] + ((c0 - d[0]) * w + 127) / 255);
+            d[1] = (uchar)(d[1] + ((c1 - d[1]) * w + 127) / 255);
+            d[2] = (uchar)(d[2] + ((c2 - d[2]) * w + 127) / 255);
+        }
+    }
+}
+
+/**
+ * @brief Desenha texto de uma fonte FreeType num tamanho fixo, sem rasterizar a cada frame.
+ *
+ * Na construção cada caractere ASCII imprimível é rasterizado uma vez num atlas alfa.
+ * Um texto novo é montado colando os glifos do atlas numa máscara só, que fica
+ * memorizada; desenhar o mesmo texto de novo é apenas uma mistura de cor com essa
+ * máscara. Textos com caracteres fora do atlas (acentos, UTF-8) são rasterizados
+ * inteiros pelo FreeType, também uma única vez.
+ */
+class TextRenderer {
+public:
+    /**
+     * @param ft2 fonte já carregada (loadFontData).
+     * @param fontHeight altura da fonte, como em FreeType2::putText.
+     * @param maxLayouts quantos textos diferentes manter memorizados.
+     */
+    TextRenderer(cv::Ptr<cv::freetype::FreeType2> ft2, int fontHeight, size_t maxLayouts = 64)
+        : ft2(ft2), fontHeight(fontHeight), maxLayouts(maxLayouts) {
+        buildAtlas();
+    }
+
+    /** @brief Mesmo resultado de FreeType2::getTextSize, memorizado por texto. */
+    cv::Size textSize(const std::string& text) {
+        return layout(text).textSize;
+    }
+
+    /**
+     * @brief Desenha o texto com a origem no canto inferior esquerdo, como
+     * FreeType2::putText(..., bottomLeftOrigin = true).
+     */
+    void draw(cv::Mat& frame, const std::string& text, cv::Point org, const cv::Scalar& color) {
+        const Layout& l = layout(text);
+        if (!l.alpha.empty())
+            blendColorMask(frame, l.alpha, org + l.offset, color);
+    }
+
+    /**
+     * @brief Como draw(), mas colando glifo a glifo do atlas, sem memorizar o texto.
+     * Para textos que mudam a cada frame (pontuação, número da fase): não aloca nada.
+     * Caracteres fora do atlas são pulados.
+     */
+    void drawGlyphs(cv::Mat& frame, const char* text, cv::Point org, const cv::Scalar& color) const {
+        for (const char* p = text; *p; p++) {
+            unsigned char c = (unsigned char)*p;
+            if (c < firstChar || c > lastChar)
+                continue;
+            const Glyph& g = glyphs[c - firstChar];
+            if (!g.rect.empty())
+                blendColorMask(frame, atlas(g.rect), org + g.offset, color);
+            org.x += g.advance;
+        }
+    }
+
+    /** @brief Tamanho do texto de drawGlyphs(): soma dos avanços e altura do glifo mais alto. */
+    cv::Size glyphsSize(const char* text) const {
+        cv::Size size(0, 0);
+        for (const char* p = text; *p; p++) {
+            unsigned char c = (unsigned char)*p;
+            if (c < firstChar || c > lastChar)
+                continue;
+            const Glyph& g = glyphs[c - firstChar];
+            size.width += g.advance;
+            size.height = std::max(size.height, g.rect.height);
+        }
+        return size;
+    }
+
+    /** @brief Caixa da tinta de drawGlyphs() em relação à origem (vazia se o texto não tem tinta). */
+    cv::Rect glyphsBounds(const char* text) const {
+        cv::Rect bounds;
+        int pen = 0;
+        for (const char* p = text; *p; p++) {
+            unsigned char c = (unsigned char)*p;
+            if (c < firstChar || c > lastChar)
+                continue;
+            const Glyph& g = glyphs[c - firstChar];
+            cv::Rect r(pen + g.offset.x, g.offset.y, g.rect.width, g.rect.height);
+            if (!r.empty())
+                bounds = bounds.empty() ? r : (bounds | r);
+            pen += g.advance;
+        }
+        return bounds;
+    }
+
+    int height() const {
+        return fontHeight;
+    }
+
+    const cv::Mat& atlasImage() const {
+        return atlas;
+    }
+
+private:
+    struct Glyph {
+        cv::Rect rect; // Região do glifo no atlas (vazia para espaço).
+        cv::Point offset; // Canto superior esquerdo do glifo em relação à caneta.
+        int advance = 0; // Quanto a caneta anda depois do glifo.
+    };
+
+    struct Layout {
+        cv::Mat alpha; // Máscara do texto inteiro.
+        cv::Point offset; // Canto superior esquerdo da máscara em relação à origem.
+        cv::Size textSize; // Tamanho informado pelo FreeType.
+    };
+
+    static const int firstChar = 32; // Espaço.
+    static const int lastChar = 126; // '~'.
+
+    cv::Size measure(const std::string& text) {
+        int baseline = 0;
+        return ft2->getTextSize(text, fontHeight, cv::FILLED, &baseline);
+    }
+
+    // Rasteriza um texto pelo FreeType numa máscara alfa recortada; devolve o recorte em out.
+    cv::Rect rasterize(const std::string& text, cv::Mat& out) {
+        cv::Size size = measure(text);
+        cv::Point origin(fontHeight, fontHeight * 2); // Margem folgada para acentos e descendentes.
+        cv::Mat cell(size.height + fontHeight * 3, size.width + fontHeight * 2, CV_8UC3, cv::Scalar::all(0));
+        ft2->putText(cell, text, origin, fontHeight, cv::Scalar::all(255), cv::FILLED, cv::LINE_AA, true);
+        cv::Mat gray;
+        cv::cvtColor(cell, gray, cv::COLOR_BGR2GRAY);
+        cv::Rect ink = cv::boundingRect(gray); // Só os pixels com tinta.
+        out = ink.empty() ? cv::Mat() : gray(ink).clone();
+        return cv::Rect(ink.x - origin.x, ink.y - origin.y, ink.width, ink.height);
+    }
+
+    void buildAtlas() {
+        std::vector<cv::Mat> images(lastChar - firstChar + 1);
+        int reference = measure("H").width;
+        int width = 0, height = 1;
+        for (int c = firstChar; c <= lastChar; c++) {
+            std::string s(1, (char)c);
+            Glyph& g = glyphs[c - firstChar];
+            cv::Rect ink = rasterize(s, images[c - firstChar]);
+            g.offset = ink.tl();
+            g.rect = cv::Rect(width, 0, ink.width, ink.height);
+            // O FreeType só informa a caixa da tinta; o avanço sai da diferença para um "H".
+            g.advance = measure(s + "H").width - reference;
+            width += ink.width;
+            height = std::max(height, ink.height);
+        }
+        atlas = cv::Mat(height, std::max(width, 1), CV_8UC1, cv::Scalar(0));
+        for (int c = firstChar; c <= lastChar; c++) {
+            const Glyph& g = glyphs[c - firstChar];
+            if (!g.rect.empty())
+                images[c - firstChar].copyTo(atlas(g.rect));
+        }
+    }
+
+    const Layout& layout(const std::string& text) {
+        auto found = layouts.find(text);
+        if (found != layouts.end())
+            return found->second;
+        if (layouts.size() >= maxLayouts)
+            layouts.clear(); // Textos que mudam muito (pontuação) não acumulam para sempre.
+
+        Layout& l = layouts[text];
+        l.textSize = measure(text);
+        bool inAtlas = true;
+        for (unsigned char c : text)
+            inAtlas = inAtlas && c >= firstChar && c <= lastChar;
+        if (!inAtlas) {
+            l.offset = rasterize(text, l.alpha).tl();
+            return l;
+        }
+
+        cv::Rect bounds; // União das caixas de todos os glifos.
+        int pen = 0;
+        for (unsigned char c : text) {
+            const Glyph& g = glyphs[c - firstChar];
+            cv::Rect r(pen + g.offset.x, g.offset.y, g.rect.width, g.rect.height);
+            if (!r.empty())
+                bounds = bounds.empty() ? r : (bounds | r);
+            pen += g.advance;
+        }
+        if (bounds.empty())
+            return l; // Só espaços.
+        l.offset = bounds.tl();
+        l.alpha = cv::Mat(bounds.size(), CV_8UC1, cv::Scalar(0));
+        pen = 0;
+        for (unsigned char c : text) {
+            const Glyph& g = glyphs[c - firstChar];
+            if (!g.rect.empty()) {
+                cv::Mat dst = l.alpha(cv::Rect(pen + g.offset.x - bounds.x, g.offset.y - bounds.y, g.rect.width, g.rect.height));
+                cv::max(dst, atlas(g.rect), dst); // Glifos vizinhos podem se sobrepor na borda.
+            }
+            pen += g.advance;
+        }
+        return l;
+    }
+
+    cv::Ptr<cv::freetype::FreeType2> ft2;
+    int fontHeight;
+    size_t maxLayouts;
+    Glyph glyphs[lastChar - firstChar + 1];
+    cv::Mat atlas;
+    std::unordered_map<std::string, Layout> layouts;
+};
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <algorithm> // std::max, std::min.
+#include <atomic> // Contadores de tarefas.
+#include <condition_variable> // Acorda as threads quando chega trabalho.
+#include <deque> // Fila de cada thread.
+#include <exception> // Exceção de um pedaço, relançada por parallelFor.
+#include <functional> // std::function das tarefas.
+#include <memory> // unique_ptr das filas.
+#include <mutex> // Protege cada fila.
+#include <thread> // Threads de trabalho.
+#include <vector> // Lista de threads e filas.
+
+/**
+ * @brief Pool de threads com roubo de tarefas ("work stealing").
+ *
+ * Cada thread do pool tem a sua própria fila, e as tarefas que ela cria entram nessa
+ * fila; threads de fora do pool dividem uma fila só. Cada thread tira tarefas do fim
+ * da sua fila e, quando fica sem trabalho, rouba do começo da fila de outra. Tarefas
+ * no fim (criadas por último) ficam com quem as criou, e as do começo vão para quem
+ * está ocioso.
+ *
+ * parallelFor() bloqueia até terminar, mas a thread que chamou também executa
+ * tarefas enquanto houver alguma; por isso pode ser chamado de dentro de outra tarefa.
+ * Quando não sobra nada para pegar, ela dorme até o último pedaço terminar.
+ */
+class ThreadPool {
+public:
+    /**
+     * @param threads número de threads de trabalho (0 = uma por núcleo, menos a que chama).
+     */
+    explicit ThreadPool(unsigned threads = 0) {
+        if (threads == 0) {
+            unsigned cores = std::thread::hardware_concurrency(); // Pode ser 0 se não for possível saber.
+            threads = cores > 1 ? cores - 1 : 1;
+        }
+        for (unsigned i = 0; i <= threads; i++) // A última fila é da(s) thread(s) de fora do pool.
+            queues.emplace_back(new Queue);
+        for (unsigned i = 0; i < threads; i++)
+            workers.emplace_back([this, i]() { workerLoop(i); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+        for (std::thread& t : workers)
+            t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /** @brief Pool compartilhado pelo programa todo, criado no primeiro uso. */
+    static ThreadPool& shared() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    /** @brief Número de threads que executam tarefas (incluindo quem chama parallelFor). */
+    unsigned size() const {
+        return (unsigned)workers.size() + 1;
+    }
+
+    /** @brief Enfileira uma tarefa avulsa; ela roda em alguma thread do pool. */
+    void submit(std::function<void()> task) {
+        push(std::move(task));
+    }
+
+    /**
+     * @brief Executa body(i) para i em [begin, end), em pedaços de grain índices.
+     * Retorna só quando todos terminarem. Se body lançar, os outros pedaços ainda
+     * terminam e a primeira exceção é relançada aqui.
+     */
+    void parallelFor(int begin, int end, const std::function<void(int)>& body, int grain = 1) {
+        if (end <= begin)
+            return;
+        grain = std::max(grain, 1);
+        int chunks = (end - begin + grain - 1) / grain;
+        if (chunks == 1) { // Não vale a pena distribuir.
+            for (int i = begin; i < end; i++)
+                body(i);
+            return;
+        }
+        std::shared_ptr<Batch> batch = std::make_shared<Batch>();
+        batch->remaining = chunks;
+        for (int start = begin; start < end; start += grain) {
+            int stop = std::min(start + grain, end);
+            // body só é usado enquanto remaining > 0, e parallelFor não sai antes disso.
+            push([&body, start, stop, batch]() {
+                try {
+                    for (int i = start; i < stop; i++)
+                        body(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(batch->mutex);
+                    if (!batch->error)
+                        batch->error = std::current_exception();
+                }
+                if (batch->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    std::lock_guard<std::mutex> lock(batch->mutex); // Não deixa o aviso cair entre o teste e o wait.
+                    batch->finished.notify_all();
+                }
+            });
+        }
+        size_t self = ownQueue();
+        while (batch->remaining.load(std::memory_order_acquire) > 0) { // Ajuda enquanto espera.
+            std::function<void()> task;
+            if (take(self, task)) {
+                task();
+                continue;
+            }
+            // Nada na fila de ninguém: os pedaços que faltam estão rodando em outras threads.
+            std::unique_lock<std::mutex> lock(batch->mutex);
+            batch->finished.wait(lock, [&batch]() { return batch->remaining.load(std::memory_order_acquire) == 0; });
+        }
+        if (batch->error)
+            std::rethrow_exception(batch->error);
+    }
+
+private:
+    // Estado de um parallelFor, compartilhado pelos pedaços.
+    struct Batch {
+        std::atomic<int> remaining{ 0 };
+        std::mutex mutex;
+        std::condition_variable finished; // Avisado quando remaining chega a 0.
+        std::exception_ptr error; // Primeira exceção lançada por body.
+    };
+
+    // Thread do pool que está rodando (a última fila, das threads de fora, se não for nenhuma).
+    struct WorkerSlot {
+        const ThreadPool* pool = nullptr;
+        size_t queue = 0;
+    };
+
+    static WorkerSlot& currentWorker() {
+        thread_local WorkerSlot slot;
+        return slot;
+    }
+
+    size_t ownQueue() const {
+        const WorkerSlot& slot = currentWorker();
+        return slot.pool == this ? slot.queue : queues.size() - 1;
+    }
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void push(std::function<void()> task) {
+        size_t index = ownQueue(); // Fica com quem criou; os outros roubam se estiverem ociosos.
+        {
+            std::lock_guard<std::mutex> lock(queues[index]->mutex);
+            queues[index]->tasks.push_back(std::move(task));
+        }
+        pending.fetch_add(1, std::memory_order_release);
+        { std::lock_guard<std::mutex> lock(sleepMutex); } // Não deixa o aviso cair entre o teste e o wait de uma thread.
+        wakeUp.notify_one();
+    }
+
+    // Pega uma tarefa: primeiro do fim da própria fila, depois do começo das outras.
+    bool take(size_t self, std::function<void()>& task) {
+        {
+            Queue& own = *queues[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                pending.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        for (size_t k = 1; k < queues.size(); k++) {
+            Queue& victim = *queues[(self + k) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                pending.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void workerLoop(size_t self) {
+        currentWorker() = WorkerSlot{ this, self };
+        for (;;) {
+            std::function<void()> task;
+            if (take(self, task)) {
+                task();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wakeUp.wait(lock, [this]() { return stopping || pending.load(std::memory_order_acquire) > 0; });
+            if (stopping && pending.load() == 0)
+                return;
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<int> pending{0};
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+    bool stopping = false;
+};